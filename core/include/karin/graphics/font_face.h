@@ -1,6 +1,7 @@
 #ifndef KARIN_GRAPHICS_FONT_FACE_H
 #define KARIN_GRAPHICS_FONT_FACE_H
 
+#include <atomic>
 #include <cstdint>
 
 namespace karin
@@ -33,10 +34,28 @@ struct GlyphMetrics
 class IFontFace
 {
 public:
+    IFontFace()
+        : m_id(nextId())
+    {}
     virtual ~IFontFace() = default;
 
     virtual FontMetrics getFontMetrics() const = 0;
     virtual GlyphMetrics getGlyphMetrics(uint32_t glyphIndex) const = 0;
+
+    // unique among the faces of the process and never reused. glyph caches are keyed by it
+    uint64_t id() const
+    {
+        return m_id;
+    }
+
+private:
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> next = 1;
+        return next++;
+    }
+
+    uint64_t m_id;
 };
 }
 
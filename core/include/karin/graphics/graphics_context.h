@@ -12,6 +12,7 @@
 #include "pattern.h"
 #include "image.h"
 #include "text_blob.h"
+#include "text_grid.h"
 
 namespace karin
 {
@@ -67,6 +68,11 @@ public:
         const Transform2D& transform = Transform2D()
     ) const;
     void drawText(const TextBlob& text, Point start, const Pattern& pattern, const Transform2D& transform = Transform2D()) const;
+    /**
+     * Draw every cell of grid with its top-left corner at start.
+     * Backgrounds of neighbouring cells with the same color are filled as one rectangle.
+     */
+    void drawTextGrid(const TextGrid& grid, Point start) const;
 
 private:
     IRendererImpl* m_rendererImpl;
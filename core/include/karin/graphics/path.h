@@ -2,6 +2,7 @@
 #define KARIN_GRAPHICS_GRAPHICS_PATH_H
 
 #include <memory>
+#include <span>
 #include <karin/common/geometry/point.h>
 
 namespace karin
@@ -14,6 +15,21 @@ public:
     Path();
     ~Path();
 
+    // a moved-from path holds no segments and can only be assigned to or destroyed
+    Path(Path&& other) noexcept;
+    Path& operator=(Path&& other) noexcept;
+
+    Path(const Path&) = delete;
+    Path& operator=(const Path&) = delete;
+
+    /**
+     * Reserve storage for segments to avoid reallocation while building large paths.
+     *
+     * @param lineCount expected number of lineTo/addPolyline points
+     * @param arcCount expected number of arcTo calls
+     */
+    void reserve(size_t lineCount, size_t arcCount = 0) const;
+
     void start(Point start) const;
     void lineTo(Point end) const;
     void arcTo(
@@ -24,6 +40,8 @@ public:
         float endAngle,
         bool isSmallArc
     ) const;
+    // append lineTo for each point
+    void addPolyline(std::span<const Point> points) const;
     void close() const;
 
 private:
@@ -31,6 +49,7 @@ private:
 
 private:
     friend class GraphicsContext;
+    friend class PathTest;
 
     PathImpl* impl() const;
 };
@@ -9,6 +9,7 @@
 
 #include "graphics_context.h"
 #include "image.h"
+#include "text_render_mode.h"
 
 namespace karin
 {
@@ -43,6 +44,10 @@ public:
     void addDrawCommand(std::function<void(GraphicsContext &)> command);
     void update() const;
     void setClearColor(const Color& color);
+    /**
+     * Select how glyphs are rasterized. Backends that scale glyph outlines natively (Direct2D) ignore this.
+     */
+    void setTextRenderMode(TextRenderMode mode);
 
     Image createImage(const std::string& filePath);
     Image createImage(const std::vector<std::byte>& data, uint32_t width, uint32_t height);
@@ -18,17 +18,27 @@ struct GlyphPosition
     Point position;
 
     uint32_t glyphIndex;
+    // 0: TextBlob::fontFace, n: TextBlob::fallbackFaces[n - 1]
+    uint32_t face = 0;
 };
 
 struct TextBlob
 {
     std::vector<GlyphPosition> glyphs;
-    std::unique_ptr<IFontFace> fontFace;
+    std::shared_ptr<IFontFace> fontFace;
     Font font;
     float fontEmSize;
 
     // actual layout size. may be smaller than specified layout size
     Size layoutSize;
+
+    // faces of the code points fontFace does not cover
+    std::vector<std::shared_ptr<IFontFace>> fallbackFaces;
+
+    const std::shared_ptr<IFontFace>& faceOf(const GlyphPosition& glyph) const
+    {
+        return glyph.face == 0 ? fontFace : fallbackFaces[glyph.face - 1];
+    }
 };
 
 }
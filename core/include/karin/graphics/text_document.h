@@ -0,0 +1,113 @@
+#ifndef KARIN_GRAPHICS_TEXT_DOCUMENT_H
+#define KARIN_GRAPHICS_TEXT_DOCUMENT_H
+
+#include "text_blob.h"
+#include "text_style.h"
+#include "paragraph_style.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace karin
+{
+class TextLayouter;
+
+// pixels, from the top of the document
+struct TextLineBox
+{
+    float top;
+    float height;
+    float baseline;
+
+    // paragraph the line belongs to
+    size_t paragraph;
+};
+
+/*
+ * Long text split into paragraphs at '\n'. Created by TextEngine::createTextDocument.
+ *
+ * Each paragraph keeps its own layout, and an edit lays out only the paragraphs it touched, when the
+ * document is queried next. Lines are found from a y position by a binary search over the cumulative
+ * line counts of the paragraphs, and layoutVisible emits the glyphs of the visible lines only.
+ */
+class TextDocument
+{
+public:
+    TextDocument(
+        std::string_view text, const TextStyle& textStyle, const ParagraphStyle& paragraphStyle, float maxWidth,
+        std::shared_ptr<IFontFace> fontFace, std::shared_ptr<TextLayouter> layouter
+    );
+
+    std::string text() const;
+    size_t size() const;
+
+    // byte offsets into text()
+    void replace(size_t offset, size_t length, std::string_view text);
+    void insert(size_t offset, std::string_view text);
+    void erase(size_t offset, size_t length);
+
+    size_t paragraphCount() const;
+    const std::string& paragraph(size_t index) const;
+
+    // 0: no wrapping. lays out every paragraph again
+    void setMaxWidth(float maxWidth);
+    float maxWidth() const;
+
+    size_t lineCount();
+    // bottom of the last line box
+    Size contentSize();
+
+    TextLineBox lineBox(size_t line);
+    // line whose box contains y, clamped to the first and last line
+    size_t lineAt(float y);
+    // first line of the paragraph
+    size_t paragraphLine(size_t paragraph);
+
+    // glyphs of the lines that intersect [top, top + height), positioned in the document
+    TextBlob layoutVisible(float top, float height);
+
+private:
+    struct Paragraph
+    {
+        std::string text;
+
+        bool laidOut = false;
+        std::vector<GlyphPosition> glyphs;
+        std::vector<std::shared_ptr<IFontFace>> fallbackFaces;
+        // index of the first glyph of each line, and the glyph count at the end
+        std::vector<uint32_t> lineGlyphStarts;
+        float width = 0.0f;
+    };
+
+    void layoutParagraph(Paragraph& paragraph) const;
+    // lays out the edited paragraphs and updates the cumulative line counts
+    void update();
+    // (paragraph, byte offset in it) of a document offset
+    std::pair<size_t, size_t> locate(size_t offset) const;
+
+    std::vector<Paragraph> m_paragraphs;
+    // line count of the paragraphs up to and including each one
+    std::vector<size_t> m_lineEnds;
+    bool m_dirty = true;
+    float m_contentWidth = 0.0f;
+
+    // same for every line
+    float m_baseline = 0.0f;
+    float m_lineHeight = 0.0f;
+
+    TextStyle m_textStyle;
+    ParagraphStyle m_paragraphStyle;
+    float m_maxWidth = 0.0f;
+    std::shared_ptr<IFontFace> m_fontFace;
+    // blob face of each paragraph face. reused by layoutVisible
+    std::vector<uint32_t> m_faceSlots;
+    std::shared_ptr<TextLayouter> m_layouter;
+};
+} // karin
+
+#endif //KARIN_GRAPHICS_TEXT_DOCUMENT_H
@@ -2,10 +2,14 @@
 #define KARIN_GRAPHICS_TEXT_ENGINE_H
 
 #include "text_blob.h"
+#include "text_document.h"
+#include "text_grid.h"
 #include "text_style.h"
 #include "paragraph_style.h"
 
+#include <future>
 #include <memory>
+#include <string>
 
 namespace karin
 {
@@ -24,6 +28,34 @@ public:
         const Size& maxSize
     );
 
+    // lays out on a worker thread, so the caller can keep drawing the previous layout.
+    // the engine may be used from any thread. queued layouts are dropped when it is destroyed
+    std::future<TextBlob> layoutTextAsync(
+        std::string text,
+        const TextStyle& textStyle,
+        const ParagraphStyle& paragraphStyle,
+        const Size& maxSize
+    );
+
+    // same layoutSize as layoutText, without placing glyphs. remembered per text, style and maxSize.width
+    Size measureText(
+        const std::string& text,
+        const TextStyle& textStyle,
+        const ParagraphStyle& paragraphStyle,
+        const Size& maxSize
+    );
+
+    // cells are sized by the advance of 'M' and the line height of textStyle's font
+    TextGrid createTextGrid(uint32_t columns, uint32_t rows, const TextStyle& textStyle);
+
+    // for long text that is edited or scrolled. maxWidth: 0 for no wrapping
+    TextDocument createTextDocument(
+        std::string_view text,
+        const TextStyle& textStyle,
+        const ParagraphStyle& paragraphStyle,
+        float maxWidth
+    );
+
 private:
     std::unique_ptr<TextEngineImpl> m_impl;
 };
@@ -0,0 +1,142 @@
+#ifndef KARIN_GRAPHICS_TEXT_GRID_H
+#define KARIN_GRAPHICS_TEXT_GRID_H
+
+#include <karin/common/color/color.h>
+#include <karin/common/geometry/size.h>
+#include "font_face.h"
+#include "font.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace karin
+{
+struct TextGridCell
+{
+    char32_t codepoint = U' ';
+    Color foreground = Color(0.0f, 0.0f, 0.0f, 1.0f);
+    // transparent: nothing is drawn behind the cell
+    Color background = Color(0.0f, 0.0f, 0.0f, 0.0f);
+
+    bool underline = false;
+    bool lineThrough = false;
+    // swaps foreground and background
+    bool inverse = false;
+
+    bool operator==(const TextGridCell& other) const = default;
+};
+
+// pixels
+struct TextGridMetrics
+{
+    Size cellSize{};
+    // from the top of a cell
+    float baseline = 0.0f;
+
+    // from the baseline, y down
+    float underlinePosition = 0.0f;
+    float underlineThickness = 0.0f;
+    float lineThroughPosition = 0.0f;
+    float lineThroughThickness = 0.0f;
+};
+
+/*
+ * Fixed-size grid of cells for terminal and log views. Created by TextEngine::createTextGrid.
+ *
+ * Every cell shows one code point at its nominal glyph, so nothing is shaped.
+ * Rows are stored in slots that follow their content when the grid scrolls. Renderers key their
+ * per-row caches by slot and rebuild a row only when the version of its slot changes.
+ */
+class TextGrid
+{
+public:
+    TextGrid() = default;
+    TextGrid(
+        uint32_t columns, uint32_t rows, std::shared_ptr<IFontFace> fontFace, Font font, float fontEmSize,
+        const TextGridMetrics& metrics
+    );
+
+    uint32_t columns() const
+    {
+        return m_columns;
+    }
+
+    uint32_t rows() const
+    {
+        return m_rows;
+    }
+
+    const TextGridMetrics& metrics() const
+    {
+        return m_metrics;
+    }
+
+    Size size() const
+    {
+        return {m_metrics.cellSize.width * m_columns, m_metrics.cellSize.height * m_rows};
+    }
+
+    const std::shared_ptr<IFontFace>& fontFace() const
+    {
+        return m_fontFace;
+    }
+
+    const Font& font() const
+    {
+        return m_font;
+    }
+
+    float fontEmSize() const
+    {
+        return m_fontEmSize;
+    }
+
+    // shared by copies. renderer caches are keyed by it
+    uint64_t id() const
+    {
+        return m_id;
+    }
+
+    const TextGridCell& cell(uint32_t column, uint32_t row) const;
+    void setCell(uint32_t column, uint32_t row, const TextGridCell& cell);
+    // one code point of the UTF-8 text per cell from column, clipped at the end of the row.
+    // the other cell fields are copied from style. return: cells written
+    uint32_t setText(uint32_t column, uint32_t row, std::string_view text, const TextGridCell& style);
+    void fillRow(uint32_t row, const TextGridCell& cell = {});
+    void clear(const TextGridCell& cell = {});
+    // count > 0 moves the content up, count < 0 down. rows scrolled in are filled with cell
+    void scroll(int32_t count, const TextGridCell& cell = {});
+    // keeps the top-left content
+    void resize(uint32_t columns, uint32_t rows, const TextGridCell& cell = {});
+
+    std::span<const TextGridCell> row(uint32_t row) const;
+    // storage slot of the row's content
+    uint32_t rowSlot(uint32_t row) const;
+    // changes whenever the content of the slot changes. unique among all grids
+    uint64_t slotVersion(uint32_t slot) const;
+
+private:
+    TextGridCell* rowData(uint32_t row);
+    void touchRow(uint32_t row);
+
+    uint64_t m_id = 0;
+    uint32_t m_columns = 0;
+    uint32_t m_rows = 0;
+
+    // by slot
+    std::vector<TextGridCell> m_cells;
+    std::vector<uint64_t> m_slotVersions;
+    // by row
+    std::vector<uint32_t> m_rowSlots;
+
+    std::shared_ptr<IFontFace> m_fontFace;
+    Font m_font;
+    float m_fontEmSize = 0.0f;
+    TextGridMetrics m_metrics;
+};
+} // karin
+
+#endif //KARIN_GRAPHICS_TEXT_GRID_H
@@ -0,0 +1,16 @@
+#ifndef KARIN_GRAPHICS_TEXT_RENDER_MODE_H
+#define KARIN_GRAPHICS_TEXT_RENDER_MODE_H
+
+namespace karin
+{
+enum class TextRenderMode
+{
+    // glyph bitmaps rasterized at the drawn size. sharpest at small sizes
+    Bitmap,
+    // one signed distance field per glyph, shared by every size and transform.
+    // suited to zooming, rotating or scaling text
+    DistanceField,
+};
+} // karin
+
+#endif //KARIN_GRAPHICS_TEXT_RENDER_MODE_H
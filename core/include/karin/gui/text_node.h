@@ -4,10 +4,13 @@
 #include <karin/graphics/text_style.h>
 #include <karin/graphics/paragraph_style.h>
 #include <karin/graphics/pattern.h>
+#include <karin/graphics/text_blob.h>
 
 #include "leaf_node.h"
 
+#include <optional>
 #include <string>
+#include <unordered_map>
 
 namespace karin::gui
 {
@@ -22,14 +25,31 @@ public:
     );
     ~TextNode() override = default;
 
+    void setText(std::string text);
+    void setTextStyle(TextStyle textStyle);
+    void setParagraphStyle(ParagraphStyle paragraphStyle);
+    void setPattern(Pattern pattern);
+
     void drawInternal(GraphicsContext& gc, const Transform2D& parentTransform) const override;
     YGSize measure(Size availableSize) const override;
 
 private:
+    // drops cached layouts and lets yoga measure this node again
+    void invalidateLayout();
+
+    // keep only a few constraint widths. yoga asks for more than one per pass
+    static constexpr size_t MAX_CACHED_MEASUREMENTS = 8;
+
     std::string m_text;
     TextStyle m_textStyle;
     ParagraphStyle m_paragraphStyle;
     Pattern m_pattern;
+
+    // laid out for m_textBlobMaxSize
+    mutable std::optional<TextBlob> m_textBlob;
+    mutable Size m_textBlobMaxSize;
+    // layout size by constraint width. the layouter does not depend on the height
+    mutable std::unordered_map<float, Size> m_measurements;
 };
 } // karin::gui
 
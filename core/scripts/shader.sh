@@ -10,22 +10,34 @@ include_guard="$2"
 
 cd "$shaders_dir" || exit 1
 
+if ! command -v glslc > /dev/null; then
+  echo "glslc has not found. install the Vulkan SDK to compile the shaders." >&2
+  exit 1
+fi
+
+# written to a temporary file so that a failed compile does not leave a partial or stale shaders.h
 output_file="shaders.h"
-echo "// This file is auto-generated by scripts/shader.sh" > "$output_file"
-echo "#ifndef $include_guard" >> "$output_file"
-echo "#define $include_guard" >> "$output_file"
+temp_file="$output_file.tmp"
+echo "// This file is auto-generated by scripts/shader.sh" > "$temp_file"
+echo "#ifndef $include_guard" >> "$temp_file"
+echo "#define $include_guard" >> "$temp_file"
 
 for shader_file in *.frag *.vert; do
   if [ -f "$shader_file" ]; then
-    glslc "$shader_file" -o "${shader_file}.spv"
-    xxd -i "${shader_file}.spv" >> "$output_file"
+    if ! glslc "$shader_file" -o "${shader_file}.spv"; then
+      echo "Failed to compile $shader_file" >&2
+      rm -f "$temp_file"
+      exit 1
+    fi
+    xxd -i "${shader_file}.spv" >> "$temp_file"
     echo "Compiled $shader_file"
   fi
 done
 
-sed -i 's/unsigned char/inline const unsigned char/' "$output_file"
-sed -i 's/unsigned int/inline const unsigned int/' "$output_file"
+sed -i 's/unsigned char/inline const unsigned char/' "$temp_file"
+sed -i 's/unsigned int/inline const unsigned int/' "$temp_file"
 
-echo "#endif // $include_guard" >> "$output_file"
+echo "#endif // $include_guard" >> "$temp_file"
 
-sed -i 's/\r$//' "$output_file"
\ No newline at end of file
+sed -i 's/\r$//' "$temp_file"
+mv "$temp_file" "$output_file"
@@ -334,8 +334,6 @@ Microsoft::WRL::ComPtr<ID2D1PathGeometry> D2DDeviceResources::pathGeometry(const
         throw std::runtime_error("Failed to create D2D path geometry");
     }
 
-    auto commands = path.commands();
-
     Microsoft::WRL::ComPtr<ID2D1GeometrySink> sink;
     hr = geometry->Open(&sink);
     if (FAILED(hr))
@@ -345,56 +343,50 @@ Microsoft::WRL::ComPtr<ID2D1PathGeometry> D2DDeviceResources::pathGeometry(const
 
     sink->SetFillMode(D2D1_FILL_MODE_ALTERNATE);
     sink->BeginFigure(toD2DPoint(path.startPoint()), D2D1_FIGURE_BEGIN_FILLED);
-    for (const auto& command : commands)
+    for (const auto& command : path.commands())
     {
-        std::visit(
-            [&sink]<typename T0>(const T0& args)
-            {
-                using T = std::decay_t<T0>;
-                if constexpr (std::is_same_v<T, PathImpl::LineArgs>)
-                {
-                    sink->AddLine(toD2DPoint(args.end));
-                }
-                else if constexpr (std::is_same_v<T, PathImpl::ArcArgs>)
-                {
-                    constexpr float twoPi = 2.0f * std::numbers::pi_v<float>;
-
-                    auto end = Point(
-                        args.center.x + args.radiusX * std::cos(args.endAngle),
-                        args.center.y + args.radiusY * std::sin(-args.endAngle) // bottom is big
-                    );
-                    float startAngle = std::fmod(args.startAngle, twoPi);
-                    float endAngle = std::fmod(args.endAngle, twoPi);
-
-                    if (startAngle < 0.0f)
-                    {
-                        startAngle += twoPi;
-                    }
-
-                    if (endAngle < 0.0f)
-                    {
-                        endAngle += twoPi;
-                    }
-
-                    D2D1_SWEEP_DIRECTION sweepDirection =
-                        args.isSmallArc
-                            ? (endAngle < startAngle
-                                   ? D2D1_SWEEP_DIRECTION_CLOCKWISE
-                                   : D2D1_SWEEP_DIRECTION_COUNTER_CLOCKWISE)
-                            : (endAngle < startAngle
-                                   ? D2D1_SWEEP_DIRECTION_COUNTER_CLOCKWISE
-                                   : D2D1_SWEEP_DIRECTION_CLOCKWISE);
-                    sink->AddArc(
-                        D2D1::ArcSegment(
-                            toD2DPoint(end),
-                            D2D1::SizeF(args.radiusX, args.radiusY),
-                            0.0f, // rotation angle
-                            sweepDirection,
-                            args.isSmallArc ? D2D1_ARC_SIZE_SMALL : D2D1_ARC_SIZE_LARGE
-                        )
-                    );
-                }
-            }, command
+        if (command.isLine())
+        {
+            sink->AddLine(toD2DPoint(command.line().end));
+            continue;
+        }
+
+        constexpr float twoPi = 2.0f * std::numbers::pi_v<float>;
+
+        auto args = command.arc();
+        auto end = Point(
+            args.center.x + args.radiusX * std::cos(args.endAngle),
+            args.center.y + args.radiusY * std::sin(-args.endAngle) // bottom is big
+        );
+        float startAngle = std::fmod(args.startAngle, twoPi);
+        float endAngle = std::fmod(args.endAngle, twoPi);
+
+        if (startAngle < 0.0f)
+        {
+            startAngle += twoPi;
+        }
+
+        if (endAngle < 0.0f)
+        {
+            endAngle += twoPi;
+        }
+
+        D2D1_SWEEP_DIRECTION sweepDirection =
+            args.isSmallArc
+                ? (endAngle < startAngle
+                       ? D2D1_SWEEP_DIRECTION_CLOCKWISE
+                       : D2D1_SWEEP_DIRECTION_COUNTER_CLOCKWISE)
+                : (endAngle < startAngle
+                       ? D2D1_SWEEP_DIRECTION_COUNTER_CLOCKWISE
+                       : D2D1_SWEEP_DIRECTION_CLOCKWISE);
+        sink->AddArc(
+            D2D1::ArcSegment(
+                toD2DPoint(end),
+                D2D1::SizeF(args.radiusX, args.radiusY),
+                0.0f, // rotation angle
+                sweepDirection,
+                args.isSmallArc ? D2D1_ARC_SIZE_SMALL : D2D1_ARC_SIZE_LARGE
+            )
         );
     }
     sink->EndFigure(D2D1_FIGURE_END_CLOSED);
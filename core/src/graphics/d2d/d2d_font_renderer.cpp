@@ -18,12 +18,6 @@ D2DFontRenderer::~D2DFontRenderer() = default;
 
 void D2DFontRenderer::drawText(const TextBlob& text, Point start, const Pattern& pattern, const Transform2D& transform) const
 {
-    auto dwriteFace = dynamic_cast<DwriteFontFace*>(text.fontFace.get());
-    if (!dwriteFace)
-    {
-        throw std::runtime_error("Unsupported font face type");
-    }
-
     D2D1_MATRIX_3X2_F oldTransform;
     m_deviceContext->GetTransform(&oldTransform);
 
@@ -37,30 +31,54 @@ void D2DFontRenderer::drawText(const TextBlob& text, Point start, const Pattern&
     glyphOffsets.reserve(text.glyphs.size());
     glyphAdvances.reserve(text.glyphs.size());
 
-    for (const auto& glyph : text.glyphs)
+    // one glyph run per run of glyphs from the same face
+    for (size_t runStart = 0; runStart < text.glyphs.size();)
     {
-        glyphIndices.push_back(static_cast<UINT16>(glyph.glyphIndex));
-        glyphOffsets.push_back(DWRITE_GLYPH_OFFSET{ glyph.position.x, -glyph.position.y });
-        glyphAdvances.push_back(0.0f); // position is calculate by offset
-    }
+        uint32_t face = text.glyphs[runStart].face;
+        size_t runEnd = runStart;
+        while (runEnd < text.glyphs.size() && text.glyphs[runEnd].face == face)
+        {
+            ++runEnd;
+        }
 
-    DWRITE_GLYPH_RUN glyphRun = {
-        .fontFace = dwriteFace->face().Get(),
-        .fontEmSize = text.fontEmSize,
-        .glyphCount = static_cast<UINT32>(text.glyphs.size()),
-        .glyphIndices = glyphIndices.data(),
-        .glyphAdvances = glyphAdvances.data(),
-        .glyphOffsets = glyphOffsets.data(),
-        .isSideways = FALSE,
-        .bidiLevel = 0
-    };
+        auto dwriteFace = dynamic_cast<DwriteFontFace*>(text.faceOf(text.glyphs[runStart]).get());
+        if (!dwriteFace)
+        {
+            m_deviceContext->SetTransform(oldTransform);
+            throw std::runtime_error("Unsupported font face type");
+        }
 
-    m_deviceContext->DrawGlyphRun(
-        D2D1::Point2F(-text.layoutSize.width / 2, -text.layoutSize.height / 2),
-        &glyphRun,
-        m_deviceResources->brush(pattern).Get(),
-        DWRITE_MEASURING_MODE_NATURAL
-    );
+        glyphIndices.clear();
+        glyphOffsets.clear();
+        glyphAdvances.clear();
+        for (size_t i = runStart; i < runEnd; ++i)
+        {
+            const auto& glyph = text.glyphs[i];
+            glyphIndices.push_back(static_cast<UINT16>(glyph.glyphIndex));
+            glyphOffsets.push_back(DWRITE_GLYPH_OFFSET{ glyph.position.x, -glyph.position.y });
+            glyphAdvances.push_back(0.0f); // position is calculate by offset
+        }
+
+        DWRITE_GLYPH_RUN glyphRun = {
+            .fontFace = dwriteFace->face().Get(),
+            .fontEmSize = text.fontEmSize,
+            .glyphCount = static_cast<UINT32>(glyphIndices.size()),
+            .glyphIndices = glyphIndices.data(),
+            .glyphAdvances = glyphAdvances.data(),
+            .glyphOffsets = glyphOffsets.data(),
+            .isSideways = FALSE,
+            .bidiLevel = 0
+        };
+
+        m_deviceContext->DrawGlyphRun(
+            D2D1::Point2F(-text.layoutSize.width / 2, -text.layoutSize.height / 2),
+            &glyphRun,
+            m_deviceResources->brush(pattern).Get(),
+            DWRITE_MEASURING_MODE_NATURAL
+        );
+
+        runStart = runEnd;
+    }
 
     m_deviceContext->SetTransform(oldTransform);
 }
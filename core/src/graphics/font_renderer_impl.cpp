@@ -0,0 +1,68 @@
+#include "font_renderer_impl.h"
+
+#include "text/harfbuzz_provider.h"
+
+#include <iostream>
+
+namespace karin
+{
+void IFontRendererImpl::drawTextGrid(const TextGrid& grid, Point start) const
+{
+    auto hbProvider = dynamic_cast<const IHarfBuzzProvider*>(grid.fontFace().get());
+    if (!hbProvider)
+    {
+        std::cerr << "Unsupported font face type in IFontRendererImpl::drawTextGrid" << std::endl;
+        return;
+    }
+
+    const TextGridMetrics& metrics = grid.metrics();
+    float scale = grid.fontEmSize() / static_cast<float>(grid.fontFace()->getFontMetrics().unitsPerEm);
+
+    TextBlob text{
+        .fontFace = grid.fontFace(),
+        .font = grid.font(),
+        .fontEmSize = grid.fontEmSize(),
+        .layoutSize = {grid.size().width, metrics.cellSize.height},
+    };
+    Color color;
+    auto flush = [&](uint32_t row)
+    {
+        if (!text.glyphs.empty())
+        {
+            drawText(text, Point(start.x, start.y + row * metrics.cellSize.height), SolidColorPattern(color));
+            text.glyphs.clear();
+        }
+    };
+
+    for (uint32_t row = 0; row < grid.rows(); ++row)
+    {
+        std::span<const TextGridCell> cells = grid.row(row);
+        for (uint32_t column = 0; column < cells.size(); ++column)
+        {
+            const TextGridCell& cell = cells[column];
+            if (cell.codepoint == U' ' || cell.codepoint == 0)
+            {
+                continue;
+            }
+
+            Color foreground = cell.inverse ? cell.background : cell.foreground;
+            if (!text.glyphs.empty() && !(foreground == color))
+            {
+                flush(row);
+            }
+            color = foreground;
+
+            hb_codepoint_t glyphIndex = 0;
+            hb_font_get_nominal_glyph(hbProvider->getHbFont(), cell.codepoint, &glyphIndex);
+            text.glyphs.push_back(GlyphPosition{
+                .position = {
+                    column * metrics.cellSize.width + grid.fontFace()->getGlyphMetrics(glyphIndex).bearingX * scale,
+                    metrics.baseline,
+                },
+                .glyphIndex = glyphIndex,
+            });
+        }
+        flush(row);
+    }
+}
+} // karin
@@ -4,7 +4,9 @@
 #include <karin/common/geometry/point.h>
 #include <karin/common/geometry/transform2d.h>
 #include <karin/graphics/pattern.h>
+#include <karin/graphics/text_render_mode.h>
 #include <karin/graphics/text_blob.h>
+#include <karin/graphics/text_grid.h>
 
 namespace karin
 {
@@ -15,6 +17,13 @@ public:
     virtual ~IFontRendererImpl() = default;
 
     virtual void drawText(const TextBlob& text, Point start, const Pattern& pattern, const Transform2D& transform = Transform2D()) const = 0;
+    // glyphs only. backgrounds and decorations are filled by GraphicsContext.
+    // by default each row is drawn as one text per foreground color
+    virtual void drawTextGrid(const TextGrid& grid, Point start) const;
+
+    virtual void setRenderMode(TextRenderMode /*mode*/)
+    {
+    }
 };
 } // karin
 
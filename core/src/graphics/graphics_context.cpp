@@ -3,6 +3,54 @@
 #include "platform.h"
 #include "graphics_context_impl.h"
 
+#include <span>
+#include <vector>
+
+namespace
+{
+using namespace karin;
+
+struct BackgroundRun
+{
+    uint32_t firstColumn;
+    uint32_t endColumn;
+    uint32_t firstRow;
+    uint32_t rowCount;
+    Color color;
+};
+
+Color foregroundColor(const TextGridCell& cell)
+{
+    return cell.inverse ? cell.background : cell.foreground;
+}
+
+Color backgroundColor(const TextGridCell& cell)
+{
+    return cell.inverse ? cell.foreground : cell.background;
+}
+
+// runs of cells with the same visible background
+void backgroundRuns(std::span<const TextGridCell> cells, uint32_t row, std::vector<BackgroundRun>& outRuns)
+{
+    outRuns.clear();
+    for (uint32_t column = 0; column < cells.size();)
+    {
+        Color color = backgroundColor(cells[column]);
+        uint32_t endColumn = column + 1;
+        while (endColumn < cells.size() && backgroundColor(cells[endColumn]) == color)
+        {
+            ++endColumn;
+        }
+
+        if (color.a > 0.0f)
+        {
+            outRuns.push_back({column, endColumn, row, 1, color});
+        }
+        column = endColumn;
+    }
+}
+}
+
 namespace karin
 {
 GraphicsContext::GraphicsContext(IRendererImpl* impl)
@@ -84,4 +132,98 @@ void GraphicsContext::drawText(const TextBlob& text, Point start, const Pattern&
 {
     m_rendererImpl->fontRenderer()->drawText(text, start, pattern, transform);
 }
+
+void GraphicsContext::drawTextGrid(const TextGrid& grid, Point start) const
+{
+    const TextGridMetrics& metrics = grid.metrics();
+    Size cellSize = metrics.cellSize;
+
+    // backgrounds: runs of one color in a row, extended over the rows below with the same run
+    std::vector<BackgroundRun> openRuns;
+    std::vector<BackgroundRun> rowRuns;
+    auto fillRun = [&](const BackgroundRun& run)
+    {
+        m_impl->fillRect(
+            Rectangle(
+                start.x + run.firstColumn * cellSize.width, start.y + run.firstRow * cellSize.height,
+                (run.endColumn - run.firstColumn) * cellSize.width, run.rowCount * cellSize.height
+            ),
+            SolidColorPattern(run.color),
+            Transform2D()
+        );
+    };
+
+    for (uint32_t row = 0; row < grid.rows(); ++row)
+    {
+        backgroundRuns(grid.row(row), row, rowRuns);
+
+        // both are sorted by column. a run continues an open run only if it covers the same columns
+        auto open = openRuns.begin();
+        for (BackgroundRun& run : rowRuns)
+        {
+            for (; open != openRuns.end() && open->firstColumn < run.firstColumn; ++open)
+            {
+                fillRun(*open);
+            }
+            if (open != openRuns.end() && open->firstColumn == run.firstColumn
+                && open->endColumn == run.endColumn && open->color == run.color)
+            {
+                run.firstRow = open->firstRow;
+                run.rowCount = open->rowCount + 1;
+                ++open;
+            }
+        }
+        for (; open != openRuns.end(); ++open)
+        {
+            fillRun(*open);
+        }
+        std::swap(openRuns, rowRuns);
+    }
+    for (const BackgroundRun& run : openRuns)
+    {
+        fillRun(run);
+    }
+
+    // underlines and strikethroughs: runs of one foreground color in a row
+    for (uint32_t row = 0; row < grid.rows(); ++row)
+    {
+        std::span<const TextGridCell> cells = grid.row(row);
+        float baseline = start.y + row * cellSize.height + metrics.baseline;
+        for (bool TextGridCell::* decoration : {&TextGridCell::underline, &TextGridCell::lineThrough})
+        {
+            float top = baseline + (decoration == &TextGridCell::underline
+                ? metrics.underlinePosition
+                : metrics.lineThroughPosition);
+            float thickness = decoration == &TextGridCell::underline
+                ? metrics.underlineThickness
+                : metrics.lineThroughThickness;
+
+            for (uint32_t column = 0; column < cells.size();)
+            {
+                if (!(cells[column].*decoration))
+                {
+                    ++column;
+                    continue;
+                }
+
+                Color color = foregroundColor(cells[column]);
+                uint32_t endColumn = column + 1;
+                while (endColumn < cells.size() && cells[endColumn].*decoration
+                    && foregroundColor(cells[endColumn]) == color)
+                {
+                    ++endColumn;
+                }
+
+                m_impl->fillRect(
+                    Rectangle(start.x + column * cellSize.width, top, (endColumn - column) * cellSize.width, thickness),
+                    SolidColorPattern(color),
+                    Transform2D()
+                );
+                column = endColumn;
+            }
+        }
+    }
+
+    m_rendererImpl->fontRenderer()->drawTextGrid(grid, start);
+}
 } // karin
@@ -11,6 +11,18 @@ Path::Path()
 
 Path::~Path() = default;
 
+Path::Path(Path&& other) noexcept = default;
+
+Path& Path::operator=(Path&& other) noexcept = default;
+
+void Path::reserve(size_t lineCount, size_t arcCount) const
+{
+    m_impl->reserve(
+        lineCount + arcCount,
+        lineCount * PathImpl::pointCount(PathImpl::Verb::LineTo) + arcCount * PathImpl::pointCount(PathImpl::Verb::SmallArcTo)
+    );
+}
+
 void Path::start(Point start) const
 {
     m_impl->start(start);
@@ -26,6 +38,11 @@ void Path::arcTo(Point center, float radiusX, float radiusY, float startAngle, f
     m_impl->arcTo(center, radiusX, radiusY, startAngle, endAngle, isSmallArc);
 }
 
+void Path::addPolyline(std::span<const Point> points) const
+{
+    m_impl->addPolyline(points);
+}
+
 void Path::close() const
 {
     m_impl->close();
@@ -15,38 +15,76 @@ PathImpl::PathImpl()
 
 void PathImpl::start(Point start)
 {
-    m_commands.clear();
+    // keep capacity so that rebuilding a path every frame does not reallocate
+    m_verbs.clear();
+    m_points.clear();
     m_currentPoint = start;
     m_startPoint = start;
 }
 
 void PathImpl::lineTo(Point end)
 {
-    m_commands.emplace_back(LineArgs{end});
+    m_verbs.push_back(Verb::LineTo);
+    m_points.push_back(end);
     m_currentPoint = end;
 }
 
 void PathImpl::arcTo(Point center, float radiusX, float radiusY, float startAngle, float endAngle, bool isSmallArc)
 {
-    m_commands.emplace_back(ArcArgs{center, radiusX, radiusY, startAngle, endAngle, isSmallArc});
+    m_verbs.push_back(isSmallArc ? Verb::SmallArcTo : Verb::LargeArcTo);
+    m_points.insert(
+        m_points.end(),
+        {
+            center,
+            Point(radiusX, radiusY),
+            Point(startAngle, endAngle),
+        }
+    );
     m_currentPoint = Point(
         center.x + radiusX * std::cos(endAngle),
         center.y + radiusY * std::sin(endAngle)
     );
 }
 
+void PathImpl::addPolyline(std::span<const Point> points)
+{
+    if (points.empty())
+    {
+        return;
+    }
+
+    m_verbs.insert(m_verbs.end(), points.size(), Verb::LineTo);
+    m_points.insert(m_points.end(), points.begin(), points.end());
+    m_currentPoint = points.back();
+}
+
 void PathImpl::close()
 {
     if (m_currentPoint != m_startPoint)
     {
-        m_commands.emplace_back(LineArgs{m_startPoint});
-        m_currentPoint = m_startPoint;
+        lineTo(m_startPoint);
     }
 }
 
-std::vector<std::variant<PathImpl::LineArgs, PathImpl::ArcArgs>> PathImpl::commands() const
+void PathImpl::reserve(size_t verbCount, size_t pointCount)
+{
+    m_verbs.reserve(verbCount);
+    m_points.reserve(pointCount);
+}
+
+PathImpl::CommandView PathImpl::commands() const
+{
+    return {m_verbs, m_points};
+}
+
+std::span<const PathImpl::Verb> PathImpl::verbs() const
+{
+    return m_verbs;
+}
+
+std::span<const Point> PathImpl::points() const
 {
-    return m_commands;
+    return m_points;
 }
 
 Point PathImpl::startPoint() const
@@ -58,4 +96,4 @@ uint32_t PathImpl::id() const
 {
     return m_id;
 }
-} // karin
\ No newline at end of file
+} // karin
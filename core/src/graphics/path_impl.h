@@ -1,17 +1,32 @@
 #ifndef SRC_GRAPHICS_GRAPHICS_PATH_IMPL_H
 #define SRC_GRAPHICS_GRAPHICS_PATH_IMPL_H
 
-#include <variant>
-#include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
 
 #include <karin/common/geometry/point.h>
 
 namespace karin
 {
+/*
+ * Path storage is structure-of-arrays:
+ * | verbs  | LineTo | ArcTo                                          | LineTo |
+ * | points | end    | center, (radiusX, radiusY), (start, end angle) | end    |
+ * commands() iterates both arrays in place without copying.
+ */
 class PathImpl
 {
 public:
+    enum class Verb : uint8_t
+    {
+        LineTo,
+        SmallArcTo,
+        LargeArcTo,
+    };
+
     struct LineArgs
     {
         Point end;
@@ -27,20 +42,138 @@ public:
         bool isSmallArc;
     };
 
+    struct Command
+    {
+        Verb verb;
+        const Point* points;
+
+        bool isLine() const
+        {
+            return verb == Verb::LineTo;
+        }
+
+        LineArgs line() const
+        {
+            return LineArgs{points[0]};
+        }
+
+        ArcArgs arc() const
+        {
+            return ArcArgs{
+                .center = points[0],
+                .radiusX = points[1].x,
+                .radiusY = points[1].y,
+                .startAngle = points[2].x,
+                .endAngle = points[2].y,
+                .isSmallArc = verb == Verb::SmallArcTo,
+            };
+        }
+    };
+
+    class CommandIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Command;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Command;
+
+        CommandIterator() = default;
+        CommandIterator(const Verb* verb, const Point* points)
+            : m_verb(verb), m_points(points)
+        {
+        }
+
+        Command operator*() const
+        {
+            return Command{*m_verb, m_points};
+        }
+
+        CommandIterator& operator++()
+        {
+            m_points += pointCount(*m_verb);
+            ++m_verb;
+            return *this;
+        }
+
+        CommandIterator operator++(int)
+        {
+            CommandIterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const CommandIterator& other) const
+        {
+            return m_verb == other.m_verb;
+        }
+
+    private:
+        const Verb* m_verb = nullptr;
+        const Point* m_points = nullptr;
+    };
+
+    // non-owning. invalidated by any modification of the path
+    class CommandView
+    {
+    public:
+        CommandView(std::span<const Verb> verbs, std::span<const Point> points)
+            : m_verbs(verbs), m_points(points)
+        {
+        }
+
+        CommandIterator begin() const
+        {
+            return {m_verbs.data(), m_points.data()};
+        }
+
+        CommandIterator end() const
+        {
+            return {m_verbs.data() + m_verbs.size(), m_points.data() + m_points.size()};
+        }
+
+        size_t size() const
+        {
+            return m_verbs.size();
+        }
+
+        bool empty() const
+        {
+            return m_verbs.empty();
+        }
+
+    private:
+        std::span<const Verb> m_verbs;
+        std::span<const Point> m_points;
+    };
+
     PathImpl();
     ~PathImpl() = default;
 
     void start(Point start);
     void lineTo(Point end);
     void arcTo(Point center, float radiusX, float radiusY, float startAngle, float endAngle, bool isSmallArc);
+    void addPolyline(std::span<const Point> points);
     void close();
 
-    std::vector<std::variant<LineArgs, ArcArgs>> commands() const;
+    // capacity hint. arcs use 3 points, lines use 1
+    void reserve(size_t verbCount, size_t pointCount);
+
+    CommandView commands() const;
+    std::span<const Verb> verbs() const;
+    std::span<const Point> points() const;
     Point startPoint() const;
     uint32_t id() const;
 
+    static constexpr size_t pointCount(Verb verb)
+    {
+        return verb == Verb::LineTo ? 1 : 3;
+    }
+
 private:
-    std::vector<std::variant<LineArgs, ArcArgs>> m_commands;
+    std::vector<Verb> m_verbs;
+    std::vector<Point> m_points;
     Point m_startPoint;
     Point m_currentPoint;
 
@@ -50,4 +183,4 @@ private:
 };
 } // karin
 
-#endif //SRC_GRAPHICS_GRAPHICS_PATH_IMPL_H
\ No newline at end of file
+#endif //SRC_GRAPHICS_GRAPHICS_PATH_IMPL_H
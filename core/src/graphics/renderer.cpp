@@ -86,6 +86,11 @@ void Renderer::setClearColor(const Color& color)
     m_impl->setClearColor(color);
 }
 
+void Renderer::setTextRenderMode(TextRenderMode mode)
+{
+    m_impl->fontRenderer()->setRenderMode(mode);
+}
+
 Image Renderer::createImage(const std::string& filePath)
 {
     int width, height, channels;
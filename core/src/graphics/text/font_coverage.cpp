@@ -0,0 +1,50 @@
+#include "font_coverage.h"
+
+#include <hb.h>
+
+#include <memory>
+
+namespace
+{
+hb_user_data_key_t fontCoverageKey;
+
+void destroyFontCoverage(void* coverage)
+{
+    delete static_cast<karin::FontCoverage*>(coverage);
+}
+}
+
+namespace karin
+{
+const FontCoverage& FontCoverage::forFont(hb_font_t* font)
+{
+    if (auto* coverage = static_cast<FontCoverage*>(hb_font_get_user_data(font, &fontCoverageKey)))
+    {
+        return *coverage;
+    }
+
+    auto created = std::make_unique<FontCoverage>();
+    hb_set_t* codepoints = hb_set_create();
+    hb_face_collect_unicodes(hb_font_get_face(font), codepoints);
+    for (hb_codepoint_t codepoint = HB_SET_VALUE_INVALID; hb_set_next(codepoints, &codepoint);)
+    {
+        created->add(codepoint);
+    }
+    hb_set_destroy(codepoints);
+
+    if (hb_font_set_user_data(font, &fontCoverageKey, created.get(), destroyFontCoverage, false))
+    {
+        return *created.release();
+    }
+
+    // another thread attached its coverage first
+    if (auto* coverage = static_cast<FontCoverage*>(hb_font_get_user_data(font, &fontCoverageKey)))
+    {
+        return *coverage;
+    }
+
+    // the inert empty font keeps no user data
+    static const FontCoverage empty;
+    return empty;
+}
+} // karin
@@ -0,0 +1,65 @@
+#ifndef SRC_GRAPHICS_TEXT_FONT_COVERAGE_H
+#define SRC_GRAPHICS_TEXT_FONT_COVERAGE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+// platform font loaders use the coverage without HarfBuzz
+struct hb_font_t;
+
+namespace karin
+{
+/*
+ * Code points a font maps to glyphs, as bitsets of 256 code point blocks.
+ * Same layout as a fontconfig charset page, so platform font databases can fill it without opening the font.
+ */
+class FontCoverage
+{
+public:
+    static constexpr uint32_t BLOCK_SIZE = 256;
+    // bit n of word w: code point block * 256 + w * 32 + n
+    using Block = std::array<uint32_t, BLOCK_SIZE / 32>;
+
+    void add(char32_t codepoint)
+    {
+        m_blocks[codepoint / BLOCK_SIZE][codepoint % BLOCK_SIZE / 32] |= 1u << (codepoint % 32);
+    }
+
+    void addBlock(uint32_t block, const Block& bits)
+    {
+        Block& target = m_blocks[block];
+        for (size_t i = 0; i < target.size(); ++i)
+        {
+            target[i] |= bits[i];
+        }
+    }
+
+    // nullptr if no code point of the block is covered
+    const Block* block(uint32_t block) const
+    {
+        auto it = m_blocks.find(block);
+        return it != m_blocks.end() ? &it->second : nullptr;
+    }
+
+    bool contains(char32_t codepoint) const
+    {
+        const Block* bits = block(codepoint / BLOCK_SIZE);
+        return bits && contains(*bits, codepoint);
+    }
+
+    static bool contains(const Block& bits, char32_t codepoint)
+    {
+        return (bits[codepoint % BLOCK_SIZE / 32] >> (codepoint % 32)) & 1u;
+    }
+
+    // coverage of the font's face. built on first use and destroyed with the font
+    static const FontCoverage& forFont(hb_font_t* font);
+
+private:
+    std::unordered_map<uint32_t, Block> m_blocks;
+};
+} // karin
+
+#endif //SRC_GRAPHICS_TEXT_FONT_COVERAGE_H
@@ -2,31 +2,134 @@
 
 #include "platform.h"
 
+#include <utils/hash.h>
+
 #include <stdexcept>
 
+namespace
+{
+size_t fileKey(const std::string& filePath, uint32_t faceIndex)
+{
+    size_t seed = 0;
+
+    hash_combine(seed, filePath);
+    hash_combine(seed, faceIndex);
+    return seed;
+}
+}
+
 namespace karin
 {
 FontLoader::FontLoader()
+    : FontLoader(createFontLoader())
+{
+}
+
+FontLoader::FontLoader(std::unique_ptr<IPlatformFontLoader> platformLoader)
+    : m_platformLoader(std::move(platformLoader))
 {
-    m_platformLoader = createFontLoader();
     if (!m_platformLoader)
     {
         throw std::runtime_error("Failed to create platform font loader");
     }
 }
 
-std::unique_ptr<IFontFace> FontLoader::loadFont(const Font& font)
+std::shared_ptr<IFontFace> FontLoader::loadFont(const Font& font)
 {
-    return m_platformLoader->loadFont(font);
+    std::lock_guard lock(m_mutex);
+
+    size_t key = font.hash();
+    if (auto it = m_fontFaces.find(key); it != m_fontFaces.end())
+    {
+        return it->second;
+    }
+
+    std::shared_ptr<IFontFace> fontFace;
+    if (auto location = m_platformLoader->findFontFile(font))
+    {
+        fontFace = loadFontFromFileLocked(location->filePath, location->faceIndex);
+    }
+    else
+    {
+        fontFace = m_platformLoader->loadFont(font);
+    }
+
+    m_fontFaces[key] = fontFace;
+    return fontFace;
 }
 
-std::unique_ptr<IFontFace> FontLoader::loadFontFromFile(const std::string& filePath)
+std::shared_ptr<IFontFace> FontLoader::loadFontFromFile(const std::string& filePath, uint32_t faceIndex)
 {
-    return m_platformLoader->loadFontFromFile(filePath);
+    std::lock_guard lock(m_mutex);
+
+    return loadFontFromFileLocked(filePath, faceIndex);
 }
 
 std::vector<Font> FontLoader::getFontLists()
 {
     return m_platformLoader->getFontLists();
 }
-} // karin
\ No newline at end of file
+
+std::shared_ptr<IFontFace> FontLoader::loadFallbackFont(const Font& font, char32_t codepoint)
+{
+    std::lock_guard lock(m_mutex);
+
+    size_t fontKey = font.hash();
+    auto fallbackIt = m_fallbackFonts.find(fontKey);
+    if (fallbackIt == m_fallbackFonts.end())
+    {
+        fallbackIt = m_fallbackFonts.emplace(fontKey, m_platformLoader->findFallbackFonts(font)).first;
+    }
+    const std::vector<FallbackFont>& fallbacks = fallbackIt->second;
+
+    uint32_t block = codepoint / FontCoverage::BLOCK_SIZE;
+    size_t blockKey = fontKey;
+    hash_combine(blockKey, block);
+    auto blockIt = m_fallbackBlocks.find(blockKey);
+    if (blockIt == m_fallbackBlocks.end())
+    {
+        std::vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < fallbacks.size(); ++i)
+        {
+            if (fallbacks[i].coverage && fallbacks[i].coverage->block(block))
+            {
+                candidates.push_back(i);
+            }
+        }
+        blockIt = m_fallbackBlocks.emplace(blockKey, std::move(candidates)).first;
+    }
+
+    for (uint32_t index : blockIt->second)
+    {
+        const FallbackFont& fallback = fallbacks[index];
+        if (fallback.coverage->contains(codepoint))
+        {
+            return loadFontFromFileLocked(fallback.location.filePath, fallback.location.faceIndex);
+        }
+    }
+    return nullptr;
+}
+
+void FontLoader::clearCache()
+{
+    std::lock_guard lock(m_mutex);
+
+    m_fontFaces.clear();
+    m_fileFaces.clear();
+    m_fallbackFonts.clear();
+    m_fallbackBlocks.clear();
+}
+
+std::shared_ptr<IFontFace> FontLoader::loadFontFromFileLocked(const std::string& filePath, uint32_t faceIndex)
+{
+    size_t key = fileKey(filePath, faceIndex);
+    if (auto it = m_fileFaces.find(key); it != m_fileFaces.end())
+    {
+        return it->second;
+    }
+
+    std::shared_ptr<IFontFace> fontFace = m_platformLoader->loadFontFromFile(filePath, faceIndex);
+    m_fileFaces[key] = fontFace;
+    return fontFace;
+}
+} // karin
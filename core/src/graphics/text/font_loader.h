@@ -6,23 +6,51 @@
 #include "font_loader_platform.h"
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace karin
 {
+/*
+ * Faces are cached and shared. A font is resolved to its file once and the face
+ * opened from that file is reused by every font resolving to the same file/index,
+ * so a cached lookup never touches the filesystem. Failed lookups are cached too.
+ *
+ * The fallback fonts of a font are queried from the platform once. The fallbacks that cover part of a
+ * 256 code point block are remembered per (font, block), so finding the face for a code point only tests
+ * a few coverage bitsets.
+ */
 class FontLoader
 {
 public:
     FontLoader();
+    explicit FontLoader(std::unique_ptr<IPlatformFontLoader> platformLoader);
     ~FontLoader() = default;
 
-    std::unique_ptr<IFontFace> loadFont(const Font& font);
-    std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath);
+    std::shared_ptr<IFontFace> loadFont(const Font& font);
+    std::shared_ptr<IFontFace> loadFontFromFile(const std::string& filePath, uint32_t faceIndex = 0);
     std::vector<Font> getFontLists();
+    // first fallback of font that covers codepoint. nullptr if none does
+    std::shared_ptr<IFontFace> loadFallbackFont(const Font& font, char32_t codepoint);
+
+    void clearCache();
 
 private:
+    std::shared_ptr<IFontFace> loadFontFromFileLocked(const std::string& filePath, uint32_t faceIndex);
+
     std::unique_ptr<IPlatformFontLoader> m_platformLoader;
+
+    std::mutex m_mutex;
+    // keyed by Font::hash()
+    std::unordered_map<size_t, std::shared_ptr<IFontFace>> m_fontFaces;
+    // keyed by hash of (file path, face index)
+    std::unordered_map<size_t, std::shared_ptr<IFontFace>> m_fileFaces;
+    // keyed by Font::hash()
+    std::unordered_map<size_t, std::vector<FallbackFont>> m_fallbackFonts;
+    // keyed by hash of (Font::hash(), code point block). indices into m_fallbackFonts
+    std::unordered_map<size_t, std::vector<uint32_t>> m_fallbackBlocks;
 };
 } // karin
 
-#endif //SRC_GRAPHICS_TEXT_FONT_LOADER_H
\ No newline at end of file
+#endif //SRC_GRAPHICS_TEXT_FONT_LOADER_H
@@ -3,21 +3,51 @@
 
 #include <karin/graphics/font_face.h>
 #include <karin/graphics/font.h>
+#include "font_coverage.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace karin
 {
+struct FontFileLocation
+{
+    std::string filePath;
+    uint32_t faceIndex = 0;
+};
+
+struct FallbackFont
+{
+    FontFileLocation location;
+    // from the platform's font database, so a font is opened only once a code point needs it
+    std::shared_ptr<const FontCoverage> coverage;
+};
+
 class IPlatformFontLoader
 {
 public:
     virtual ~IPlatformFontLoader() = default;
 
     virtual std::unique_ptr<IFontFace> loadFont(const Font& font) = 0;
-    virtual std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath) = 0;
+    virtual std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath, uint32_t faceIndex = 0) = 0;
     virtual std::vector<Font> getFontLists() = 0;
+
+    // resolves a font to the file backing it without opening the file.
+    // platforms that do not load faces by file return nullopt and loadFont() is used instead
+    virtual std::optional<FontFileLocation> findFontFile(const Font& /*font*/)
+    {
+        return std::nullopt;
+    }
+
+    // fonts to try, in order, for the code points the font does not cover. slow; callers should cache the result
+    virtual std::vector<FallbackFont> findFallbackFonts(const Font& /*font*/)
+    {
+        return {};
+    }
 };
 } // karin
 
-#endif //SRC_GRAPHICS_TEXT_FONT_LOADER_PLATFORM_H
\ No newline at end of file
+#endif //SRC_GRAPHICS_TEXT_FONT_LOADER_PLATFORM_H
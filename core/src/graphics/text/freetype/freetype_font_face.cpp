@@ -11,7 +11,22 @@ namespace karin
 {
 FreetypeFontFace::FreetypeFontFace(FT_Face face)
 {
-    hb_face_t* hbFace = hb_ft_face_create(face, nullptr);
+    // HarfBuzz reads tables from the font data itself when it is in memory (also memory-mapped files),
+    // so shaping on other threads never goes through the FT_Face
+    hb_face_t* hbFace;
+    if (face->stream->base)
+    {
+        hb_blob_t* blob = hb_blob_create(
+            reinterpret_cast<const char*>(face->stream->base), static_cast<unsigned int>(face->stream->size),
+            HB_MEMORY_MODE_READONLY, nullptr, nullptr
+        );
+        hbFace = hb_face_create(blob, static_cast<unsigned int>(face->face_index));
+        hb_blob_destroy(blob);
+    }
+    else
+    {
+        hbFace = hb_ft_face_create(face, nullptr);
+    }
     m_fbFont = hb_font_create(hbFace);
     hb_ot_font_set_funcs(m_fbFont);
     hb_font_set_scale(m_fbFont, face->units_per_EM, face->units_per_EM);
@@ -19,6 +34,10 @@ FreetypeFontFace::FreetypeFontFace(FT_Face face)
     hb_face_destroy(hbFace);
 
     m_face = face;
+
+    m_fontMetrics = loadFontMetrics();
+    m_glyphMetrics.resize(face->num_glyphs);
+    m_glyphMetricsLoaded.resize(face->num_glyphs, 0);
 }
 
 FreetypeFontFace::~FreetypeFontFace()
@@ -42,6 +61,35 @@ FT_Face FreetypeFontFace::face()
 }
 
 FontMetrics FreetypeFontFace::getFontMetrics() const
+{
+    return m_fontMetrics;
+}
+
+GlyphMetrics FreetypeFontFace::getGlyphMetrics(uint32_t glyphIndex) const
+{
+    std::lock_guard lock(m_glyphMetricsMutex);
+
+    if (glyphIndex >= m_glyphMetrics.size())
+    {
+        return loadGlyphMetrics(glyphIndex);
+    }
+
+    if (!m_glyphMetricsLoaded[glyphIndex])
+    {
+        m_glyphMetrics[glyphIndex] = loadGlyphMetrics(glyphIndex);
+        m_glyphMetricsLoaded[glyphIndex] = 1;
+    }
+
+    return m_glyphMetrics[glyphIndex];
+}
+
+std::optional<GlyphOutline> FreetypeFontFace::loadGlyphOutline(uint32_t glyphIndex) const
+{
+    std::lock_guard lock(m_glyphMetricsMutex);
+    return GlyphOutline::load(m_face, glyphIndex);
+}
+
+FontMetrics FreetypeFontFace::loadFontMetrics() const
 {
     FontMetrics metrics{
         .unitsPerEm = m_face->units_per_EM,
@@ -115,7 +163,7 @@ FontMetrics FreetypeFontFace::getFontMetrics() const
     return metrics;
 }
 
-GlyphMetrics FreetypeFontFace::getGlyphMetrics(uint32_t glyphIndex) const
+GlyphMetrics FreetypeFontFace::loadGlyphMetrics(uint32_t glyphIndex) const
 {
     FT_Error error = FT_Load_Glyph(m_face, glyphIndex, FT_LOAD_NO_BITMAP | FT_LOAD_NO_SCALE);
     if (error)
@@ -1,6 +1,8 @@
 #ifndef SRC_GRAPHICS_TEXT_FREETYPE_FREETYPE_FONT_FACE_H
 #define SRC_GRAPHICS_TEXT_FREETYPE_FREETYPE_FONT_FACE_H
 
+#include "glyph_outline.h"
+
 #include <text/harfbuzz_provider.h>
 #include <karin/graphics/font_face.h>
 
@@ -8,6 +10,11 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
 namespace karin
 {
 class FreetypeFontFace : public IFontFace, public IHarfBuzzProvider
@@ -22,11 +29,24 @@ public:
     hb_font_t* getHbFont() const override;
     FontMetrics getFontMetrics() const override;
     GlyphMetrics getGlyphMetrics(uint32_t glyphIndex) const override;
+    // nullopt if the glyph has no outline
+    std::optional<GlyphOutline> loadGlyphOutline(uint32_t glyphIndex) const;
     FT_Face face();
 
 private:
+    FontMetrics loadFontMetrics() const;
+    GlyphMetrics loadGlyphMetrics(uint32_t glyphIndex) const;
+
     hb_font_t *m_fbFont;
     FT_Face m_face;
+
+    FontMetrics m_fontMetrics;
+
+    // guards the glyph slot of m_face too, which metrics and outlines are loaded into
+    mutable std::mutex m_glyphMetricsMutex;
+    // indexed by glyph id, filled on first use. unscaled font units
+    mutable std::vector<GlyphMetrics> m_glyphMetrics;
+    mutable std::vector<uint8_t> m_glyphMetricsLoaded;
 };
 } // karin
 
@@ -0,0 +1,345 @@
+#include "glyph_outline.h"
+
+#include FT_OUTLINE_H
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+using namespace karin;
+
+// same limit as the feathered fills of VulkanTessellator
+constexpr float MAX_FEATHER_MITER_RATIO = 4.0f;
+constexpr int MAX_CURVE_SEGMENTS = 64;
+// em units. crossings closer than this to a band edge do not split the band
+constexpr float BAND_EPSILON = 1e-6f;
+
+struct DecomposeContext
+{
+    std::vector<std::vector<Point>>* contours;
+    float scale;
+    Point current;
+};
+
+Point toPoint(const FT_Vector* vector, float scale)
+{
+    // y up in font units, y down in the outline
+    return {static_cast<float>(vector->x) * scale, -static_cast<float>(vector->y) * scale};
+}
+
+float length(Point point)
+{
+    return std::sqrt(point.x * point.x + point.y * point.y);
+}
+
+Point scaled(Point point, float scale)
+{
+    return {point.x * scale, point.y * scale};
+}
+
+void addPoint(DecomposeContext& context, Point point)
+{
+    // zero length edges have no normal to feather along
+    std::vector<Point>& contour = context.contours->back();
+    if (contour.empty() || !(contour.back() == point))
+    {
+        contour.push_back(point);
+    }
+    context.current = point;
+}
+
+int segmentCount(float secondDifference, float factor)
+{
+    // the flattening error of n segments is secondDifference * factor / n^2
+    float count = std::ceil(std::sqrt(secondDifference * factor / GlyphOutline::FLATTEN_TOLERANCE));
+    return std::clamp(static_cast<int>(count), 1, MAX_CURVE_SEGMENTS);
+}
+
+int moveTo(const FT_Vector* to, void* user)
+{
+    auto& context = *static_cast<DecomposeContext*>(user);
+    context.contours->emplace_back();
+    addPoint(context, toPoint(to, context.scale));
+    return 0;
+}
+
+int lineTo(const FT_Vector* to, void* user)
+{
+    auto& context = *static_cast<DecomposeContext*>(user);
+    addPoint(context, toPoint(to, context.scale));
+    return 0;
+}
+
+int conicTo(const FT_Vector* control, const FT_Vector* to, void* user)
+{
+    auto& context = *static_cast<DecomposeContext*>(user);
+    Point p0 = context.current;
+    Point p1 = toPoint(control, context.scale);
+    Point p2 = toPoint(to, context.scale);
+
+    int count = segmentCount(length(p0 - p1 - p1 + p2), 0.25f);
+    for (int i = 1; i <= count; ++i)
+    {
+        float t = static_cast<float>(i) / static_cast<float>(count);
+        float u = 1.0f - t;
+        addPoint(context, scaled(p0, u * u) + scaled(p1, 2.0f * u * t) + scaled(p2, t * t));
+    }
+    return 0;
+}
+
+int cubicTo(const FT_Vector* control1, const FT_Vector* control2, const FT_Vector* to, void* user)
+{
+    auto& context = *static_cast<DecomposeContext*>(user);
+    Point p0 = context.current;
+    Point p1 = toPoint(control1, context.scale);
+    Point p2 = toPoint(control2, context.scale);
+    Point p3 = toPoint(to, context.scale);
+
+    float secondDifference = std::max(length(p0 - p1 - p1 + p2), length(p1 - p2 - p2 + p3));
+    int count = segmentCount(secondDifference, 0.75f);
+    for (int i = 1; i <= count; ++i)
+    {
+        float t = static_cast<float>(i) / static_cast<float>(count);
+        float u = 1.0f - t;
+        addPoint(
+            context,
+            scaled(p0, u * u * u) + scaled(p1, 3.0f * u * u * t) + scaled(p2, 3.0f * u * t * t) + scaled(p3, t * t * t)
+        );
+    }
+    return 0;
+}
+
+// an edge of the outline, top to bottom
+struct Edge
+{
+    Point top;
+    Point bottom;
+    // +1 if the contour runs down along the edge
+    int winding;
+
+    // the last vertex added on the edge. bands below start where it is
+    float vertexY = 0.0f;
+    uint32_t vertex = UINT32_MAX;
+
+    float xAt(float y) const
+    {
+        return top.x + (bottom.x - top.x) * (y - top.y) / (bottom.y - top.y);
+    }
+};
+
+uint32_t fillVertex(Edge& edge, float y, GlyphOutline::Mesh& mesh)
+{
+    if (edge.vertex == UINT32_MAX || edge.vertexY != y)
+    {
+        edge.vertex = static_cast<uint32_t>(mesh.vertices.size());
+        edge.vertexY = y;
+        mesh.vertices.push_back({.position = {edge.xAt(y), y}, .feather = {0.0f, 0.0f}, .coverage = 1.0f});
+    }
+    return edge.vertex;
+}
+
+void addTrapezoid(float top, float bottom, Edge& left, Edge& right, GlyphOutline::Mesh& mesh)
+{
+    uint32_t topLeft = fillVertex(left, top, mesh);
+    uint32_t topRight = fillVertex(right, top, mesh);
+    uint32_t bottomRight = fillVertex(right, bottom, mesh);
+    uint32_t bottomLeft = fillVertex(left, bottom, mesh);
+    mesh.indices.insert(mesh.indices.end(), {topLeft, topRight, bottomRight, bottomRight, bottomLeft, topLeft});
+}
+
+// fill the band between top and bottom, crossed by every edge of active.
+// bands are split where edges cross, so edges keep their order within a band
+void fillBand(float top, float bottom, std::vector<Edge*>& active, GlyphOutline::Mesh& mesh)
+{
+    float middle = (top + bottom) / 2.0f;
+    std::ranges::sort(active, {}, [middle](const Edge* edge) { return edge->xAt(middle); });
+
+    for (size_t i = 0; i + 1 < active.size(); ++i)
+    {
+        float differenceTop = active[i]->xAt(top) - active[i + 1]->xAt(top);
+        float differenceBottom = active[i]->xAt(bottom) - active[i + 1]->xAt(bottom);
+        if (differenceTop <= BAND_EPSILON && differenceBottom <= BAND_EPSILON)
+        {
+            continue;
+        }
+
+        float crossing = top + (bottom - top) * differenceTop / (differenceTop - differenceBottom);
+        if (crossing > top + BAND_EPSILON && crossing < bottom - BAND_EPSILON)
+        {
+            fillBand(top, crossing, active, mesh);
+            fillBand(crossing, bottom, active, mesh);
+            return;
+        }
+    }
+
+    int winding = 0;
+    Edge* left = nullptr;
+    for (Edge* edge : active)
+    {
+        int previous = winding;
+        winding += edge->winding;
+        if (previous == 0 && winding != 0)
+        {
+            left = edge;
+        }
+        else if (previous != 0 && winding == 0)
+        {
+            addTrapezoid(top, bottom, *left, *edge, mesh);
+        }
+    }
+}
+
+void addFill(const std::vector<std::vector<Point>>& contours, GlyphOutline::Mesh& mesh)
+{
+    std::vector<Edge> edges;
+    std::vector<float> ys;
+    for (const auto& contour : contours)
+    {
+        for (size_t i = 0; i < contour.size(); ++i)
+        {
+            Point from = contour[i];
+            Point to = contour[(i + 1) % contour.size()];
+            ys.push_back(from.y);
+            if (from.y < to.y)
+            {
+                edges.push_back({from, to, 1});
+            }
+            else if (from.y > to.y)
+            {
+                edges.push_back({to, from, -1});
+            }
+        }
+    }
+    std::ranges::sort(ys);
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+    std::ranges::sort(edges, {}, [](const Edge& edge) { return edge.top.y; });
+
+    // every vertex starts a band, so each edge crosses whole bands
+    std::vector<Edge*> active;
+    size_t nextEdge = 0;
+    for (size_t i = 0; i + 1 < ys.size(); ++i)
+    {
+        std::erase_if(active, [&](const Edge* edge) { return edge->bottom.y <= ys[i]; });
+        for (; nextEdge < edges.size() && edges[nextEdge].top.y <= ys[i]; ++nextEdge)
+        {
+            active.push_back(&edges[nextEdge]);
+        }
+        fillBand(ys[i], ys[i + 1], active, mesh);
+    }
+}
+
+void addFeather(const std::vector<std::vector<Point>>& contours, GlyphOutline::Mesh& mesh)
+{
+    // the fill is on the same side of every edge. outer contours decide which
+    float signedArea = 0.0f;
+    for (const auto& contour : contours)
+    {
+        for (size_t i = 0; i < contour.size(); ++i)
+        {
+            Point from = contour[i];
+            Point to = contour[(i + 1) % contour.size()];
+            signedArea += from.x * to.y - to.x * from.y;
+        }
+    }
+    float outward = signedArea < 0.0f ? -1.0f : 1.0f;
+
+    for (const auto& contour : contours)
+    {
+        size_t count = contour.size();
+        auto edgeNormal = [&](size_t from, size_t to)
+        {
+            Point direction = contour[to] - contour[from];
+            float edgeLength = length(direction);
+            return edgeLength > 0.0f ? Point{-direction.y / edgeLength, direction.x / edgeLength} : Point{0.0f, 0.0f};
+        };
+
+        // the ring is centered on the outline, like the feathered fills of VulkanTessellator
+        auto base = static_cast<uint32_t>(mesh.vertices.size());
+        std::vector<Point> offsets(count, Point{0.0f, 0.0f});
+        for (size_t i = 0; i < count; ++i)
+        {
+            Point normalSum = edgeNormal((i + count - 1) % count, i) + edgeNormal(i, (i + 1) % count);
+            float normalSumLength = length(normalSum);
+            if (normalSumLength > 0.0f)
+            {
+                float miterRatio = std::min(2.0f / normalSumLength, MAX_FEATHER_MITER_RATIO);
+                offsets[i] = scaled(normalSum, outward * miterRatio / (2.0f * normalSumLength));
+            }
+            mesh.vertices.push_back({.position = contour[i], .feather = -offsets[i], .coverage = 1.0f});
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            mesh.vertices.push_back({.position = contour[i], .feather = offsets[i], .coverage = 0.0f});
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto next = static_cast<uint32_t>((i + 1) % count);
+            auto inner = base + static_cast<uint32_t>(i);
+            auto innerNext = base + next;
+            auto outer = base + static_cast<uint32_t>(count + i);
+            auto outerNext = base + static_cast<uint32_t>(count) + next;
+            mesh.indices.insert(mesh.indices.end(), {inner, outer, outerNext, outerNext, innerNext, inner});
+        }
+    }
+}
+}
+
+namespace karin
+{
+std::optional<GlyphOutline> GlyphOutline::load(FT_Face face, uint32_t glyphIndex)
+{
+    if (!FT_IS_SCALABLE(face) || face->units_per_EM == 0)
+    {
+        return std::nullopt;
+    }
+
+    if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) != 0
+        || face->glyph->format != FT_GLYPH_FORMAT_OUTLINE)
+    {
+        return std::nullopt;
+    }
+
+    GlyphOutline outline;
+    DecomposeContext context{
+        .contours = &outline.m_contours,
+        .scale = 1.0f / static_cast<float>(face->units_per_EM),
+        .current = {0.0f, 0.0f},
+    };
+    FT_Outline_Funcs funcs{
+        .move_to = moveTo,
+        .line_to = lineTo,
+        .conic_to = conicTo,
+        .cubic_to = cubicTo,
+        .shift = 0,
+        .delta = 0,
+    };
+    if (FT_Outline_Decompose(&face->glyph->outline, &funcs, &context) != 0)
+    {
+        return std::nullopt;
+    }
+
+    outline.m_bearingX = static_cast<float>(face->glyph->metrics.horiBearingX) * context.scale;
+
+    // contours are closed implicitly
+    for (auto& contour : outline.m_contours)
+    {
+        if (contour.size() > 1 && contour.front() == contour.back())
+        {
+            contour.pop_back();
+        }
+    }
+    std::erase_if(outline.m_contours, [](const std::vector<Point>& contour) { return contour.size() < 3; });
+
+    return outline;
+}
+
+GlyphOutline::Mesh GlyphOutline::tessellate() const
+{
+    Mesh mesh{.bearingX = m_bearingX};
+    addFill(m_contours, mesh);
+    addFeather(m_contours, mesh);
+    return mesh;
+}
+} // karin
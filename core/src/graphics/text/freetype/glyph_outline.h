@@ -0,0 +1,68 @@
+#ifndef SRC_GRAPHICS_TEXT_FREETYPE_GLYPH_OUTLINE_H
+#define SRC_GRAPHICS_TEXT_FREETYPE_GLYPH_OUTLINE_H
+
+#include <karin/common/geometry/point.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace karin
+{
+/*
+ * Outline of a glyph, flattened to closed polygons in em units (1.0 = em size), y down from the pen position.
+ * GlyphPosition::position is the pen position plus bearingX, so placing an outline there takes bearingX off.
+ * Loaded once without scaling or hinting, so one outline serves every size and transform.
+ */
+class GlyphOutline
+{
+public:
+    // triangles of the outline filled by the nonzero rule, with a ring around the outline to anti-alias its edges
+    struct Mesh
+    {
+        struct Vertex
+        {
+            // em units
+            Point position;
+            // moves the vertex across the outline per pixel of anti-aliasing width. zero inside the fill
+            Point feather;
+            // 1.0 inside the fill, 0.0 at the outer edge of the ring
+            float coverage;
+        };
+
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        // em units
+        float bearingX = 0.0f;
+    };
+
+    // nullopt if the glyph has no outline (e.g. bitmap-only fonts) or fails to load.
+    // loads into the face's glyph slot, so callers serialize access to face
+    static std::optional<GlyphOutline> load(FT_Face face, uint32_t glyphIndex);
+
+    const std::vector<std::vector<Point>>& contours() const
+    {
+        return m_contours;
+    }
+
+    // left bearing in em units
+    float bearingX() const
+    {
+        return m_bearingX;
+    }
+
+    Mesh tessellate() const;
+
+    // maximum distance between a curve and its flattened polygon, in em units
+    static constexpr float FLATTEN_TOLERANCE = 1.0f / 2048.0f;
+
+private:
+    std::vector<std::vector<Point>> m_contours;
+    float m_bearingX = 0.0f;
+};
+} // karin
+
+#endif //SRC_GRAPHICS_TEXT_FREETYPE_GLYPH_OUTLINE_H
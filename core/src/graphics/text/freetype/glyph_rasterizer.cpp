@@ -0,0 +1,253 @@
+#include "glyph_rasterizer.h"
+
+#include FT_MODULE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace
+{
+using namespace karin;
+
+struct WorkerFace
+{
+    std::weak_ptr<const void> owner;
+    FT_Face face = nullptr;
+};
+
+// opens the font of source again in library. the memory of memory faces and memory-mapped files is shared
+FT_Face openFaceCopy(FT_Library library, FT_Face source)
+{
+    FT_Face face = nullptr;
+    FT_Stream stream = source->stream;
+    FT_Error error;
+    if (stream->base)
+    {
+        error = FT_New_Memory_Face(library, stream->base, static_cast<FT_Long>(stream->size), source->face_index, &face);
+    }
+    else if (stream->pathname.pointer)
+    {
+        error = FT_New_Face(library, static_cast<const char*>(stream->pathname.pointer), source->face_index, &face);
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    return error ? nullptr : face;
+}
+
+FT_Face workerFace(FT_Library library, std::unordered_map<FT_Face, WorkerFace>& faces, const GlyphRasterizer::Request& request)
+{
+    auto it = faces.find(request.face);
+    if (it != faces.end() && it->second.owner.expired())
+    {
+        // the source face was destroyed and another one got its address
+        FT_Done_Face(it->second.face);
+        faces.erase(it);
+        it = faces.end();
+    }
+
+    if (it == faces.end())
+    {
+        FT_Face face = openFaceCopy(library, request.face);
+        if (!face)
+        {
+            return nullptr;
+        }
+        it = faces.emplace(request.face, WorkerFace{request.owner, face}).first;
+    }
+
+    return it->second.face;
+}
+
+GlyphRasterizer::Glyph rasterizeGlyph(FT_Library library, FT_Face face, const GlyphRasterizer::Request& request)
+{
+    GlyphRasterizer::Glyph glyph;
+
+    bool distanceField = request.format == GlyphRasterizer::Format::DistanceField;
+    glyph.error = FT_Set_Char_Size(face, 0, std::lround(request.size * 64.0f), 72, 72);
+    if (glyph.error)
+    {
+        return glyph;
+    }
+
+    // a distance field is scaled freely, so hinting for its raster size would only distort it
+    glyph.error = FT_Load_Glyph(face, request.glyphIndex, distanceField ? FT_LOAD_NO_HINTING : FT_LOAD_DEFAULT);
+    if (glyph.error)
+    {
+        return glyph;
+    }
+
+    FT_GlyphSlot slot = face->glyph;
+    if (slot->format == FT_GLYPH_FORMAT_OUTLINE && slot->outline.n_points == 0)
+    {
+        // empty outline (e.g. space)
+        return glyph;
+    }
+
+    FT_Render_Mode renderMode = FT_RENDER_MODE_NORMAL;
+#if KARIN_FREETYPE_HAS_SDF
+    if (distanceField)
+    {
+        FT_Int spread = request.spread;
+        FT_Property_Set(library, "sdf", "spread", &spread);
+        FT_Property_Set(library, "bsdf", "spread", &spread);
+        renderMode = FT_RENDER_MODE_SDF;
+    }
+#else
+    (void)library;
+#endif
+
+    glyph.error = FT_Render_Glyph(slot, renderMode);
+    if (glyph.error)
+    {
+        return glyph;
+    }
+
+    glyph.width = static_cast<int>(slot->bitmap.width);
+    glyph.height = static_cast<int>(slot->bitmap.rows);
+    glyph.left = slot->bitmap_left;
+    glyph.top = slot->bitmap_top;
+    glyph.bearingX = static_cast<float>(slot->metrics.horiBearingX) / 64.0f;
+
+    glyph.bitmap.resize(static_cast<size_t>(glyph.width) * glyph.height);
+    for (int row = 0; row < glyph.height; ++row)
+    {
+        std::memcpy(
+            glyph.bitmap.data() + static_cast<size_t>(row) * glyph.width,
+            slot->bitmap.buffer + static_cast<ptrdiff_t>(row) * slot->bitmap.pitch,
+            glyph.width
+        );
+    }
+
+    return glyph;
+}
+}
+
+namespace karin
+{
+GlyphRasterizer::GlyphRasterizer(size_t threadCount)
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_threads.emplace_back(&GlyphRasterizer::workerLoop, this);
+    }
+}
+
+GlyphRasterizer::~GlyphRasterizer()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+std::vector<GlyphRasterizer::Glyph> GlyphRasterizer::rasterize(std::span<const Request> requests)
+{
+    std::vector<Glyph> results(requests.size());
+    if (requests.empty())
+    {
+        return results;
+    }
+
+    std::unique_lock lock(m_mutex);
+    m_requests = requests;
+    m_results = &results;
+    m_nextRequest = 0;
+    m_busyWorkers = m_threads.size();
+    ++m_batch;
+    m_wakeCondition.notify_all();
+
+    m_doneCondition.wait(lock, [this] { return m_busyWorkers == 0; });
+    m_requests = {};
+    m_results = nullptr;
+
+    return results;
+}
+
+size_t GlyphRasterizer::defaultThreadCount()
+{
+    // leave a core to the thread that waits for the batch
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+}
+
+void GlyphRasterizer::workerLoop()
+{
+    FT_Library library = nullptr;
+    if (FT_Init_FreeType(&library))
+    {
+        std::cerr << "failed to initialize freetype for a glyph rasterizer thread" << std::endl;
+    }
+
+    std::unordered_map<FT_Face, WorkerFace> faces;
+    uint64_t batch = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_wakeCondition.wait(lock, [this, batch] { return m_stopping || m_batch != batch; });
+            if (m_stopping)
+            {
+                break;
+            }
+            batch = m_batch;
+        }
+
+        std::erase_if(
+            faces, [](const auto& entry)
+            {
+                if (entry.second.owner.expired())
+                {
+                    FT_Done_Face(entry.second.face);
+                    return true;
+                }
+                return false;
+            }
+        );
+
+        size_t index;
+        while ((index = m_nextRequest.fetch_add(1)) < m_requests.size())
+        {
+            const Request& request = m_requests[index];
+            FT_Face face = library ? workerFace(library, faces, request) : nullptr;
+            if (!face)
+            {
+                (*m_results)[index].error = FT_Err_Cannot_Open_Resource;
+                continue;
+            }
+            (*m_results)[index] = rasterizeGlyph(library, face, request);
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            if (--m_busyWorkers == 0)
+            {
+                m_doneCondition.notify_one();
+            }
+        }
+    }
+
+    for (const auto& [source, workerFace] : faces)
+    {
+        FT_Done_Face(workerFace.face);
+    }
+    if (library)
+    {
+        FT_Done_FreeType(library);
+    }
+}
+} // karin
@@ -0,0 +1,111 @@
+#ifndef SRC_GRAPHICS_TEXT_FREETYPE_GLYPH_RASTERIZER_H
+#define SRC_GRAPHICS_TEXT_FREETYPE_GLYPH_RASTERIZER_H
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+// FT_RENDER_MODE_SDF was added in FreeType 2.11
+#if FREETYPE_MAJOR > 2 || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR >= 11)
+#define KARIN_FREETYPE_HAS_SDF 1
+#else
+#define KARIN_FREETYPE_HAS_SDF 0
+#endif
+
+namespace karin
+{
+/*
+ * Rasterizes batches of glyphs on a pool of worker threads.
+ * FreeType objects must not be shared between threads, so every worker owns an FT_Library
+ * and opens its own FT_Face for each source face it is given.
+ */
+class GlyphRasterizer
+{
+public:
+    enum class Format
+    {
+        Coverage,
+        // signed distance field. 128 is the outline, see FT_RENDER_MODE_SDF
+        DistanceField,
+    };
+
+    struct Request
+    {
+        // only read to open a worker copy of the face
+        FT_Face face = nullptr;
+        // keeps the face (and the memory it reads from) alive. worker copies are dropped once it expires
+        std::shared_ptr<const void> owner;
+
+        uint32_t glyphIndex = 0;
+        // em size in pixels
+        float size = 0.0f;
+        Format format = Format::Coverage;
+        // distance in pixels covered on each side of the outline. DistanceField only
+        int spread = 8;
+    };
+
+    struct Glyph
+    {
+        // 8-bit, tightly packed
+        std::vector<std::byte> bitmap;
+        int width = 0;
+        int height = 0;
+        // offset of the bitmap from the pen position in pixels. y up
+        int left = 0;
+        int top = 0;
+        // left bearing at the raster size in pixels. GlyphPosition::position already includes it
+        float bearingX = 0.0f;
+
+        FT_Error error = 0;
+    };
+
+    explicit GlyphRasterizer(size_t threadCount = defaultThreadCount());
+    ~GlyphRasterizer();
+
+    GlyphRasterizer(const GlyphRasterizer&) = delete;
+    GlyphRasterizer& operator=(const GlyphRasterizer&) = delete;
+
+    // blocks until every request is rasterized. results are in request order
+    std::vector<Glyph> rasterize(std::span<const Request> requests);
+
+    size_t threadCount() const
+    {
+        return m_threads.size();
+    }
+
+    static size_t defaultThreadCount();
+
+    static constexpr bool supportsDistanceField()
+    {
+        return KARIN_FREETYPE_HAS_SDF;
+    }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_doneCondition;
+    bool m_stopping = false;
+
+    // current batch. written under m_mutex before m_batch is incremented
+    uint64_t m_batch = 0;
+    std::span<const Request> m_requests;
+    std::vector<Glyph>* m_results = nullptr;
+    std::atomic<size_t> m_nextRequest = 0;
+    size_t m_busyWorkers = 0;
+};
+} // karin
+
+#endif //SRC_GRAPHICS_TEXT_FREETYPE_GLYPH_RASTERIZER_H
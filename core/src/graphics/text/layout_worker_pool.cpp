@@ -0,0 +1,67 @@
+#include "layout_worker_pool.h"
+
+#include <algorithm>
+
+namespace karin
+{
+LayoutWorkerPool::LayoutWorkerPool(size_t threadCount)
+    : m_threadCount(std::max<size_t>(threadCount, 1))
+{
+}
+
+LayoutWorkerPool::~LayoutWorkerPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+size_t LayoutWorkerPool::defaultThreadCount()
+{
+    // leave a core to the UI thread
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+}
+
+void LayoutWorkerPool::enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+
+        // threads are started on demand, so an engine that never lays out asynchronously has none
+        if (m_threads.size() < m_threadCount)
+        {
+            m_threads.emplace_back(&LayoutWorkerPool::workerLoop, this);
+        }
+    }
+    m_condition.notify_one();
+}
+
+void LayoutWorkerPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping)
+            {
+                break;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
+} // karin
@@ -0,0 +1,56 @@
+#ifndef SRC_GRAPHICS_TEXT_LAYOUT_WORKER_POOL_H
+#define SRC_GRAPHICS_TEXT_LAYOUT_WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace karin
+{
+/*
+ * Runs text layouts on a pool of worker threads. Threads are started by the first submitted task.
+ * Tasks still queued when the pool is destroyed are dropped, and their futures report a broken promise.
+ */
+class LayoutWorkerPool
+{
+public:
+    explicit LayoutWorkerPool(size_t threadCount = defaultThreadCount());
+    ~LayoutWorkerPool();
+
+    LayoutWorkerPool(const LayoutWorkerPool&) = delete;
+    LayoutWorkerPool& operator=(const LayoutWorkerPool&) = delete;
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& function)
+    {
+        // std::function needs a copyable target
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(function));
+        std::future<std::invoke_result_t<F>> future = task->get_future();
+        enqueue([task] { (*task)(); });
+        return future;
+    }
+
+    static size_t defaultThreadCount();
+
+private:
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+
+    size_t m_threadCount;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stopping = false;
+};
+} // karin
+
+#endif //SRC_GRAPHICS_TEXT_LAYOUT_WORKER_POOL_H
@@ -0,0 +1,127 @@
+#include "shape_cache.h"
+
+#include <utils/hash.h>
+
+namespace karin
+{
+size_t ShapeCache::Key::hash() const
+{
+    size_t seed = 0;
+
+    hash_combine(seed, text);
+    hash_combine(seed, font);
+    hash_combine(seed, direction);
+    hash_combine(seed, language);
+    return seed;
+}
+
+bool ShapeCache::Entry::matches(const Key& key) const
+{
+    return font == key.font
+        && direction == key.direction
+        && text == key.text
+        && language == key.language;
+}
+
+ShapeCache::ShapeCache(size_t byteBudget)
+    : m_byteBudget(byteBudget)
+{
+}
+
+std::shared_ptr<const ShapedRun> ShapeCache::find(const Key& key)
+{
+    std::lock_guard lock(m_mutex);
+
+    auto it = m_lookup.find(key.hash());
+    if (it == m_lookup.end() || !it->second->matches(key))
+    {
+        return nullptr;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->run;
+}
+
+void ShapeCache::insert(const Key& key, std::shared_ptr<const void> fontOwner, std::shared_ptr<const ShapedRun> run)
+{
+    std::lock_guard lock(m_mutex);
+
+    size_t hash = key.hash();
+    if (auto it = m_lookup.find(hash); it != m_lookup.end())
+    {
+        // same key shaped twice concurrently, or a hash collision. keep the newest
+        m_byteSize -= it->second->byteSize;
+        m_entries.erase(it->second);
+        m_lookup.erase(it);
+    }
+
+    size_t byteSize = sizeof(Entry) + sizeof(ShapedRun)
+        + key.text.size() + key.language.size()
+        + run->glyphs.size() * sizeof(ShapedGlyph);
+    if (byteSize > m_byteBudget)
+    {
+        return;
+    }
+
+    m_entries.push_front(Entry{
+        .hash = hash,
+        .text = std::string(key.text),
+        .font = key.font,
+        .direction = key.direction,
+        .language = std::string(key.language),
+        .fontOwner = std::move(fontOwner),
+        .run = std::move(run),
+        .byteSize = byteSize,
+    });
+    m_lookup[hash] = m_entries.begin();
+    m_byteSize += byteSize;
+
+    evict();
+}
+
+void ShapeCache::clear()
+{
+    std::lock_guard lock(m_mutex);
+
+    m_entries.clear();
+    m_lookup.clear();
+    m_byteSize = 0;
+}
+
+void ShapeCache::setByteBudget(size_t byteBudget)
+{
+    std::lock_guard lock(m_mutex);
+
+    m_byteBudget = byteBudget;
+    evict();
+}
+
+size_t ShapeCache::byteBudget() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_byteBudget;
+}
+
+size_t ShapeCache::byteSize() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_byteSize;
+}
+
+size_t ShapeCache::size() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+void ShapeCache::evict()
+{
+    while (m_byteSize > m_byteBudget && !m_entries.empty())
+    {
+        const Entry& entry = m_entries.back();
+        m_byteSize -= entry.byteSize;
+        m_lookup.erase(entry.hash);
+        m_entries.pop_back();
+    }
+}
+} // karin
@@ -0,0 +1,88 @@
+#ifndef SRC_GRAPHICS_TEXT_SHAPE_CACHE_H
+#define SRC_GRAPHICS_TEXT_SHAPE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace karin
+{
+// one shaped glyph. advance is in font units
+struct ShapedGlyph
+{
+    uint32_t glyphIndex;
+    uint32_t cluster; // byte offset in the run text
+    int32_t advanceX;
+};
+
+struct ShapedRun
+{
+    std::vector<ShapedGlyph> glyphs;
+};
+
+/*
+ * LRU cache of shaped runs keyed by (UTF-8 text, font, direction, language).
+ * Memory is bounded by an approximate byte budget. Thread-safe.
+ */
+class ShapeCache
+{
+public:
+    struct Key
+    {
+        std::string_view text;
+        // identifies the shaping font. kept alive by the entry, see insert()
+        const void* font;
+        uint8_t direction;
+        std::string_view language;
+
+        size_t hash() const;
+    };
+
+    static constexpr size_t DEFAULT_BYTE_BUDGET = 4 * 1024 * 1024;
+
+    explicit ShapeCache(size_t byteBudget = DEFAULT_BYTE_BUDGET);
+    ~ShapeCache() = default;
+
+    std::shared_ptr<const ShapedRun> find(const Key& key);
+    // fontOwner keeps key.font alive while the entry exists, so its address cannot be reused
+    void insert(const Key& key, std::shared_ptr<const void> fontOwner, std::shared_ptr<const ShapedRun> run);
+    void clear();
+
+    void setByteBudget(size_t byteBudget);
+    size_t byteBudget() const;
+    size_t byteSize() const;
+    size_t size() const;
+
+private:
+    struct Entry
+    {
+        size_t hash;
+        std::string text;
+        const void* font;
+        uint8_t direction;
+        std::string language;
+        std::shared_ptr<const void> fontOwner;
+        std::shared_ptr<const ShapedRun> run;
+        size_t byteSize;
+
+        bool matches(const Key& key) const;
+    };
+
+    void evict();
+
+    mutable std::mutex m_mutex;
+    // front is the most recently used
+    std::list<Entry> m_entries;
+    std::unordered_map<size_t, std::list<Entry>::iterator> m_lookup;
+    size_t m_byteBudget;
+    size_t m_byteSize = 0;
+};
+} // karin
+
+#endif //SRC_GRAPHICS_TEXT_SHAPE_CACHE_H
@@ -0,0 +1,438 @@
+#include "simple_shaper.h"
+
+#include <hb-ot.h>
+
+#include <iterator>
+#include <limits>
+#include <memory>
+
+namespace
+{
+hb_user_data_key_t simpleShaperKey;
+
+// features HarfBuzz turns on for horizontal left-to-right text
+constexpr hb_tag_t DEFAULT_FEATURES[] = {
+    HB_TAG('r', 'v', 'r', 'n'), HB_TAG('l', 't', 'r', 'a'), HB_TAG('l', 't', 'r', 'm'), HB_TAG('r', 'a', 'n', 'd'),
+    HB_TAG('a', 'b', 'v', 'm'), HB_TAG('b', 'l', 'w', 'm'), HB_TAG('c', 'c', 'm', 'p'), HB_TAG('l', 'o', 'c', 'l'),
+    HB_TAG('m', 'a', 'r', 'k'), HB_TAG('m', 'k', 'm', 'k'), HB_TAG('r', 'l', 'i', 'g'), HB_TAG('c', 'a', 'l', 't'),
+    HB_TAG('c', 'l', 'i', 'g'), HB_TAG('c', 'u', 'r', 's'), HB_TAG('d', 'i', 's', 't'), HB_TAG('k', 'e', 'r', 'n'),
+    HB_TAG('l', 'i', 'g', 'a'), HB_TAG('r', 'c', 'l', 't'),
+    HB_TAG_NONE,
+};
+constexpr hb_tag_t KERN_FEATURE[] = {HB_TAG('k', 'e', 'r', 'n'), HB_TAG_NONE};
+
+// scripts HarfBuzz picks lookups from for Latin text, and for text of only digits and punctuation
+constexpr hb_tag_t LATIN_SCRIPTS[] = {HB_TAG('l', 'a', 't', 'n'), HB_TAG('D', 'F', 'L', 'T'), HB_TAG('d', 'f', 'l', 't')};
+constexpr hb_tag_t COMMON_SCRIPTS[] = {HB_TAG('D', 'F', 'L', 'T'), HB_TAG('d', 'f', 'l', 't'), HB_TAG('l', 'a', 't', 'n')};
+
+void destroySimpleShaper(void* shaper)
+{
+    delete static_cast<karin::SimpleShaper*>(shaper);
+}
+
+// characters HarfBuzz does not map to their nominal glyph as is
+bool isSpecialCodepoint(uint32_t codepoint)
+{
+    return codepoint < 0x20 // C0 controls
+        || (codepoint >= 0x7F && codepoint <= 0x9F) // DEL and C1 controls
+        || codepoint == 0xAD; // soft hyphen is default ignorable
+}
+
+bool hasTable(hb_face_t* face, hb_tag_t tag)
+{
+    hb_blob_t* blob = hb_face_reference_table(face, tag);
+    bool found = hb_blob_get_length(blob) > 0;
+    hb_blob_destroy(blob);
+    return found;
+}
+
+// HB_OT_LAYOUT_NO_SCRIPT_INDEX if the table has none of scripts
+template<size_t N>
+unsigned int selectScript(hb_face_t* face, hb_tag_t table, const hb_tag_t (&scripts)[N])
+{
+    unsigned int scriptIndex;
+    hb_tag_t chosenScript;
+    return hb_ot_layout_table_select_script(face, table, N, scripts, &scriptIndex, &chosenScript)
+        ? scriptIndex
+        : HB_OT_LAYOUT_NO_SCRIPT_INDEX;
+}
+
+void collectFeatureLookups(hb_face_t* face, hb_tag_t table, unsigned int featureIndex, hb_set_t* outLookups)
+{
+    unsigned int lookups[32];
+    unsigned int start = 0;
+    unsigned int count;
+    do
+    {
+        count = std::size(lookups);
+        hb_ot_layout_feature_get_lookups(face, table, featureIndex, start, &count, lookups);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            hb_set_add(outLookups, lookups[i]);
+        }
+        start += count;
+    } while (count == std::size(lookups));
+}
+
+// lookups of features (and the required feature) in the default language system of the script
+void collectLookups(
+    hb_face_t* face,
+    hb_tag_t table,
+    unsigned int scriptIndex,
+    const hb_tag_t* features,
+    hb_set_t* outLookups
+)
+{
+    if (scriptIndex == HB_OT_LAYOUT_NO_SCRIPT_INDEX)
+    {
+        return;
+    }
+
+    unsigned int featureIndex;
+    if (hb_ot_layout_language_get_required_feature_index(
+        face, table, scriptIndex, HB_OT_LAYOUT_DEFAULT_LANGUAGE_INDEX, &featureIndex
+    ))
+    {
+        collectFeatureLookups(face, table, featureIndex, outLookups);
+    }
+    for (; *features != HB_TAG_NONE; ++features)
+    {
+        if (hb_ot_layout_language_find_feature(
+            face, table, scriptIndex, HB_OT_LAYOUT_DEFAULT_LANGUAGE_INDEX, *features, &featureIndex
+        ))
+        {
+            collectFeatureLookups(face, table, featureIndex, outLookups);
+        }
+    }
+}
+
+struct ShapedCodepoints
+{
+    hb_glyph_info_t* infos;
+    hb_glyph_position_t* positions;
+    unsigned int count;
+};
+
+ShapedCodepoints shapeCodepoints(hb_font_t* font, hb_buffer_t* buffer, const std::vector<uint32_t>& codepoints)
+{
+    hb_buffer_clear_contents(buffer);
+    hb_buffer_add_codepoints(buffer, codepoints.data(), static_cast<int>(codepoints.size()), 0, -1);
+    hb_buffer_set_direction(buffer, HB_DIRECTION_LTR);
+    hb_buffer_set_script(buffer, HB_SCRIPT_LATIN);
+    hb_shape(font, buffer, nullptr, 0);
+
+    ShapedCodepoints shaped{};
+    shaped.infos = hb_buffer_get_glyph_infos(buffer, &shaped.count);
+    shaped.positions = hb_buffer_get_glyph_positions(buffer, &shaped.count);
+    return shaped;
+}
+}
+
+namespace karin
+{
+SimpleShaper::SimpleShaper(hb_font_t* font)
+{
+    hb_face_t* face = hb_font_get_face(font);
+
+    // digits and punctuation alone are shaped with the default script, letters with latn.
+    // one table serves both only if they run the same lookups
+    for (hb_tag_t table : {HB_OT_TAG_GSUB, HB_OT_TAG_GPOS})
+    {
+        hb_set_t* latin = hb_set_create();
+        hb_set_t* common = hb_set_create();
+        collectLookups(face, table, selectScript(face, table, LATIN_SCRIPTS), DEFAULT_FEATURES, latin);
+        collectLookups(face, table, selectScript(face, table, COMMON_SCRIPTS), DEFAULT_FEATURES, common);
+        bool same = hb_set_is_equal(latin, common);
+        hb_set_destroy(latin);
+        hb_set_destroy(common);
+        if (!same)
+        {
+            return;
+        }
+    }
+
+    for (uint32_t codepoint = 0; codepoint < m_glyphIndices.size(); ++codepoint)
+    {
+        hb_codepoint_t glyph = 0;
+        if (isSpecialCodepoint(codepoint) || !hb_font_get_nominal_glyph(font, codepoint, &glyph))
+        {
+            continue;
+        }
+        m_glyphIndices[codepoint] = glyph;
+        m_advances[codepoint] = hb_font_get_glyph_h_advance(font, glyph);
+    }
+
+    buildPairTable(font);
+    m_supported = true;
+}
+
+const SimpleShaper* SimpleShaper::forFont(hb_font_t* font, std::string_view locale)
+{
+    auto* shaper = static_cast<SimpleShaper*>(hb_font_get_user_data(font, &simpleShaperKey));
+    if (!shaper)
+    {
+        auto created = std::make_unique<SimpleShaper>(font);
+        if (hb_font_set_user_data(font, &simpleShaperKey, created.get(), destroySimpleShaper, false))
+        {
+            shaper = created.release();
+        }
+        else
+        {
+            // another thread attached its table first, or the font is the inert empty font
+            shaper = static_cast<SimpleShaper*>(hb_font_get_user_data(font, &simpleShaperKey));
+        }
+    }
+
+    // the table is built for the default language system
+    return shaper && shaper->m_supported && !usesLanguageSystem(hb_font_get_face(font), locale) ? shaper : nullptr;
+}
+
+bool SimpleShaper::shape(std::string_view text, std::vector<ShapedGlyph>& outGlyphs) const
+{
+    outGlyphs.clear();
+
+    const auto* str = reinterpret_cast<const unsigned char*>(text.data());
+    uint32_t previous = 0;
+    for (size_t i = 0; i < text.size();)
+    {
+        auto cluster = static_cast<uint32_t>(i);
+        uint32_t codepoint = str[i];
+        if (codepoint >= 0x80)
+        {
+            // U+0080 - U+00FF are 0xC2 or 0xC3 followed by a continuation byte
+            if ((codepoint != 0xC2 && codepoint != 0xC3) || i + 1 >= text.size() || (str[i + 1] & 0xC0) != 0x80)
+            {
+                return false;
+            }
+            codepoint = ((codepoint & 0x1F) << 6) | (str[i + 1] & 0x3F);
+            i += 2;
+        }
+        else
+        {
+            ++i;
+        }
+
+        uint32_t glyphIndex = m_glyphIndices[codepoint];
+        if (glyphIndex == 0)
+        {
+            return false;
+        }
+        int32_t advance = m_advances[codepoint];
+        if (!outGlyphs.empty())
+        {
+            PairAdjustment pair = m_pairAdjustments[m_pairSlots[previous] * m_pairStride + m_pairSlots[codepoint]];
+            if (pair.first == NEEDS_SHAPING)
+            {
+                return false;
+            }
+            outGlyphs.back().advanceX += pair.first;
+            advance += pair.second;
+        }
+        outGlyphs.push_back(ShapedGlyph{
+            .glyphIndex = glyphIndex,
+            .cluster = cluster,
+            .advanceX = advance,
+        });
+        previous = codepoint;
+    }
+
+    return true;
+}
+
+bool SimpleShaper::usesLanguageSystem(hb_face_t* face, std::string_view locale)
+{
+    hb_language_t language = hb_language_from_string(locale.data(), static_cast<int>(locale.size()));
+    unsigned int scriptCount = HB_OT_MAX_TAGS_PER_SCRIPT;
+    hb_tag_t scriptTags[HB_OT_MAX_TAGS_PER_SCRIPT];
+    unsigned int languageCount = HB_OT_MAX_TAGS_PER_LANGUAGE;
+    hb_tag_t languageTags[HB_OT_MAX_TAGS_PER_LANGUAGE];
+    hb_ot_tags_from_script_and_language(
+        HB_SCRIPT_LATIN, language, &scriptCount, scriptTags, &languageCount, languageTags
+    );
+    if (languageCount == 0)
+    {
+        return false;
+    }
+
+    for (hb_tag_t table : {HB_OT_TAG_GSUB, HB_OT_TAG_GPOS})
+    {
+        for (const auto& scripts : {LATIN_SCRIPTS, COMMON_SCRIPTS})
+        {
+            unsigned int scriptIndex;
+            hb_tag_t chosenScript;
+            unsigned int languageIndex;
+            if (hb_ot_layout_table_select_script(face, table, 3, scripts, &scriptIndex, &chosenScript)
+                && hb_ot_layout_script_select_language(
+                    face, table, scriptIndex, languageCount, languageTags, &languageIndex
+                ))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void SimpleShaper::buildPairTable(hb_font_t* font)
+{
+    hb_face_t* face = hb_font_get_face(font);
+
+    // glyphs a lookup of the default features reads. the others keep their nominal advance next to any glyph
+    hb_set_t* touched = hb_set_create();
+    hb_set_t* gposKern = hb_set_create();
+    for (hb_tag_t table : {HB_OT_TAG_GSUB, HB_OT_TAG_GPOS})
+    {
+        hb_set_t* lookups = hb_set_create();
+        collectLookups(face, table, selectScript(face, table, LATIN_SCRIPTS), DEFAULT_FEATURES, lookups);
+        for (hb_codepoint_t lookup = HB_SET_VALUE_INVALID; hb_set_next(lookups, &lookup);)
+        {
+            hb_ot_layout_lookup_collect_glyphs(face, table, lookup, touched, touched, touched, nullptr);
+        }
+        hb_set_destroy(lookups);
+    }
+    collectLookups(
+        face, HB_OT_TAG_GPOS, selectScript(face, HB_OT_TAG_GPOS, LATIN_SCRIPTS), KERN_FEATURE, gposKern
+    );
+    // the kern table (used when GPOS has no kerning) and AAT tables cannot be read glyph by glyph
+    bool touchesAll = (hb_set_is_empty(gposKern) && hasTable(face, HB_TAG('k', 'e', 'r', 'n')))
+        || hasTable(face, HB_TAG('m', 'o', 'r', 'x'))
+        || hasTable(face, HB_TAG('m', 'o', 'r', 't'))
+        || hasTable(face, HB_TAG('k', 'e', 'r', 'x'));
+    hb_set_destroy(gposKern);
+
+    std::vector<uint32_t> pairCodepoints;
+    // a glyph no lookup reads, so the shaping on either side of it does not interact
+    uint32_t separator = 0;
+    for (uint32_t codepoint = 0; codepoint < m_glyphIndices.size(); ++codepoint)
+    {
+        uint32_t glyph = m_glyphIndices[codepoint];
+        if (glyph == 0)
+        {
+            continue;
+        }
+        if (touchesAll || hb_set_has(touched, glyph))
+        {
+            pairCodepoints.push_back(codepoint);
+        }
+        else if (separator == 0
+            && hb_ot_layout_get_glyph_class(face, glyph) != HB_OT_LAYOUT_GLYPH_CLASS_MARK)
+        {
+            separator = codepoint;
+        }
+    }
+    hb_set_destroy(touched);
+    if (pairCodepoints.empty())
+    {
+        return;
+    }
+
+    hb_buffer_t* buffer = hb_buffer_create();
+    std::vector<uint32_t> codepoints;
+    std::vector<uint32_t> expected;
+    // shapes each group of codepoints, separated when there is a separator and one at a time otherwise.
+    // onGroup gets the positions of a group, or nullptr if HarfBuzz does not give its nominal glyphs
+    auto shapeGroups = [&](const std::vector<std::vector<uint32_t>>& groups, auto&& onGroup)
+    {
+        if (separator != 0)
+        {
+            codepoints.clear();
+            expected.clear();
+            for (const auto& group : groups)
+            {
+                codepoints.insert(codepoints.end(), group.begin(), group.end());
+                codepoints.push_back(separator);
+            }
+            for (uint32_t codepoint : codepoints)
+            {
+                expected.push_back(m_glyphIndices[codepoint]);
+            }
+
+            ShapedCodepoints shaped = shapeCodepoints(font, buffer, codepoints);
+            bool nominal = shaped.count == expected.size();
+            for (unsigned int i = 0; nominal && i < shaped.count; ++i)
+            {
+                nominal = shaped.infos[i].codepoint == expected[i];
+            }
+            if (nominal)
+            {
+                size_t offset = 0;
+                for (const auto& group : groups)
+                {
+                    onGroup(shaped.positions + offset);
+                    offset += group.size() + 1;
+                }
+                return;
+            }
+        }
+
+        // a substitution somewhere in the line. find which group it is in
+        for (const auto& group : groups)
+        {
+            ShapedCodepoints shaped = shapeCodepoints(font, buffer, group);
+            bool nominal = shaped.count == group.size();
+            for (unsigned int i = 0; nominal && i < shaped.count; ++i)
+            {
+                nominal = shaped.infos[i].codepoint == m_glyphIndices[group[i]];
+            }
+            onGroup(nominal ? shaped.positions : nullptr);
+        }
+    };
+
+    // glyphs on their own. substituted ones are left to HarfBuzz
+    std::vector<std::vector<uint32_t>> groups;
+    for (uint32_t codepoint : pairCodepoints)
+    {
+        groups.push_back({codepoint});
+    }
+    auto single = pairCodepoints.begin();
+    shapeGroups(groups, [&](const hb_glyph_position_t* positions)
+    {
+        if (positions)
+        {
+            m_advances[*single] = positions[0].x_advance;
+        }
+        else
+        {
+            m_glyphIndices[*single] = 0;
+        }
+        ++single;
+    });
+    std::erase_if(pairCodepoints, [this](uint32_t codepoint) { return m_glyphIndices[codepoint] == 0; });
+
+    m_pairStride = pairCodepoints.size() + 1;
+    m_pairAdjustments.assign(m_pairStride * m_pairStride, {0, 0});
+    for (size_t slot = 1; slot < m_pairStride; ++slot)
+    {
+        m_pairSlots[pairCodepoints[slot - 1]] = static_cast<uint8_t>(slot);
+    }
+
+    // every pair, one line per first glyph
+    for (uint32_t first : pairCodepoints)
+    {
+        groups.clear();
+        for (uint32_t second : pairCodepoints)
+        {
+            groups.push_back({first, second});
+        }
+        auto second = pairCodepoints.begin();
+        shapeGroups(groups, [&](const hb_glyph_position_t* positions)
+        {
+            PairAdjustment& pair = m_pairAdjustments[m_pairSlots[first] * m_pairStride + m_pairSlots[*second]];
+            int32_t firstAdjustment = positions ? positions[0].x_advance - m_advances[first] : 0;
+            int32_t secondAdjustment = positions ? positions[1].x_advance - m_advances[*second] : 0;
+            if (!positions
+                || firstAdjustment <= NEEDS_SHAPING || firstAdjustment > std::numeric_limits<int16_t>::max()
+                || secondAdjustment <= NEEDS_SHAPING || secondAdjustment > std::numeric_limits<int16_t>::max())
+            {
+                pair = {NEEDS_SHAPING, 0};
+            }
+            else
+            {
+                pair = {static_cast<int16_t>(firstAdjustment), static_cast<int16_t>(secondAdjustment)};
+            }
+            ++second;
+        });
+    }
+    hb_buffer_destroy(buffer);
+}
+} // karin
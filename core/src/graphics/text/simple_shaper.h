@@ -0,0 +1,61 @@
+#ifndef SRC_GRAPHICS_TEXT_SIMPLE_SHAPER_H
+#define SRC_GRAPHICS_TEXT_SIMPLE_SHAPER_H
+
+#include "shape_cache.h"
+
+#include <hb.h>
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace karin
+{
+/*
+ * Shapes left-to-right Latin-1 text from a table of nominal glyphs, advances and pair adjustments, without hb_shape.
+ * The table is filled by shaping every letter and every pair of letters once with HarfBuzz, so kerning is the
+ * same as hb_shape. Pairs that HarfBuzz substitutes (ligatures, contextual alternates) are left to HarfBuzz.
+ * Lookups that only match three or more Latin-1 glyphs, without matching their first two, are not detected.
+ */
+class SimpleShaper
+{
+public:
+    explicit SimpleShaper(hb_font_t* font);
+
+    // nullptr if the font needs HarfBuzz for text in locale. built on first use and destroyed with the font
+    static const SimpleShaper* forFont(hb_font_t* font, std::string_view locale);
+
+    // same glyphs as hb_shape with a left-to-right direction. false if text has a code point the table
+    // does not cover (outside Latin-1, a control or default ignorable character, or missing from the font),
+    // or a pair of code points that HarfBuzz substitutes
+    bool shape(std::string_view text, std::vector<ShapedGlyph>& outGlyphs) const;
+
+private:
+    // added to the advances of two adjacent glyphs, in font units
+    struct PairAdjustment
+    {
+        int16_t first;
+        int16_t second;
+    };
+
+    // pair is substituted by HarfBuzz
+    static constexpr int16_t NEEDS_SHAPING = INT16_MIN;
+
+    static bool usesLanguageSystem(hb_face_t* face, std::string_view locale);
+
+    void buildPairTable(hb_font_t* font);
+
+    bool m_supported = false;
+    // by code point. glyph 0: not covered
+    std::array<uint32_t, 256> m_glyphIndices{};
+    // font units
+    std::array<int32_t, 256> m_advances{};
+    // by code point. row and column of m_pairAdjustments, 0: no lookup touches the glyph
+    std::array<uint8_t, 256> m_pairSlots{};
+    size_t m_pairStride = 1;
+    std::vector<PairAdjustment> m_pairAdjustments{{0, 0}};
+};
+} // karin
+
+#endif //SRC_GRAPHICS_TEXT_SIMPLE_SHAPER_H
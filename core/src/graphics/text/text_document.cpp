@@ -0,0 +1,297 @@
+#include <karin/graphics/text_document.h>
+
+#include "text_layouter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace karin
+{
+TextDocument::TextDocument(
+    std::string_view text, const TextStyle& textStyle, const ParagraphStyle& paragraphStyle, float maxWidth,
+    std::shared_ptr<IFontFace> fontFace, std::shared_ptr<TextLayouter> layouter
+)
+    : m_textStyle(textStyle),
+      m_paragraphStyle(paragraphStyle),
+      m_maxWidth(maxWidth),
+      m_fontFace(std::move(fontFace)),
+      m_layouter(std::move(layouter))
+{
+    TextLayouter::LineMetrics lineMetrics = TextLayouter::lineMetrics(m_fontFace.get(), m_textStyle, m_paragraphStyle);
+    m_baseline = lineMetrics.baseline;
+    m_lineHeight = lineMetrics.lineHeight;
+
+    m_paragraphs.emplace_back();
+    replace(0, 0, text);
+}
+
+std::string TextDocument::text() const
+{
+    std::string result;
+    result.reserve(size());
+    for (size_t i = 0; i < m_paragraphs.size(); ++i)
+    {
+        if (i > 0)
+        {
+            result += '\n';
+        }
+        result += m_paragraphs[i].text;
+    }
+    return result;
+}
+
+size_t TextDocument::size() const
+{
+    size_t result = m_paragraphs.size() - 1;
+    for (const auto& paragraph : m_paragraphs)
+    {
+        result += paragraph.text.size();
+    }
+    return result;
+}
+
+void TextDocument::replace(size_t offset, size_t length, std::string_view text)
+{
+    auto [first, firstOffset] = locate(offset);
+    auto [last, lastOffset] = locate(offset + length);
+
+    std::string edited = m_paragraphs[first].text.substr(0, firstOffset);
+    edited += text;
+    edited += std::string_view(m_paragraphs[last].text).substr(lastOffset);
+
+    // the edited paragraphs are replaced, the others keep their layout
+    std::vector<Paragraph> paragraphs;
+    for (size_t lineStart = 0; lineStart <= edited.size();)
+    {
+        size_t lineEnd = std::min(edited.find('\n', lineStart), edited.size());
+        paragraphs.push_back({.text = edited.substr(lineStart, lineEnd - lineStart)});
+        lineStart = lineEnd + 1;
+    }
+
+    auto it = m_paragraphs.erase(m_paragraphs.begin() + first, m_paragraphs.begin() + last + 1);
+    m_paragraphs.insert(it, std::make_move_iterator(paragraphs.begin()), std::make_move_iterator(paragraphs.end()));
+    m_dirty = true;
+}
+
+void TextDocument::insert(size_t offset, std::string_view text)
+{
+    replace(offset, 0, text);
+}
+
+void TextDocument::erase(size_t offset, size_t length)
+{
+    replace(offset, length, {});
+}
+
+size_t TextDocument::paragraphCount() const
+{
+    return m_paragraphs.size();
+}
+
+const std::string& TextDocument::paragraph(size_t index) const
+{
+    return m_paragraphs.at(index).text;
+}
+
+void TextDocument::setMaxWidth(float maxWidth)
+{
+    if (maxWidth == m_maxWidth)
+    {
+        return;
+    }
+
+    m_maxWidth = maxWidth;
+    for (auto& paragraph : m_paragraphs)
+    {
+        paragraph.laidOut = false;
+    }
+    m_dirty = true;
+}
+
+float TextDocument::maxWidth() const
+{
+    return m_maxWidth;
+}
+
+size_t TextDocument::lineCount()
+{
+    update();
+    return m_lineEnds.back();
+}
+
+Size TextDocument::contentSize()
+{
+    update();
+    return {m_contentWidth, static_cast<float>(m_lineEnds.back()) * m_lineHeight};
+}
+
+TextLineBox TextDocument::lineBox(size_t line)
+{
+    update();
+    if (line >= m_lineEnds.back())
+    {
+        throw std::out_of_range("text document line is out of range");
+    }
+
+    auto paragraph = static_cast<size_t>(std::upper_bound(m_lineEnds.begin(), m_lineEnds.end(), line) - m_lineEnds.begin());
+    return TextLineBox{
+        .top = static_cast<float>(line) * m_lineHeight,
+        .height = m_lineHeight,
+        .baseline = m_baseline + static_cast<float>(line) * m_lineHeight,
+        .paragraph = paragraph,
+    };
+}
+
+size_t TextDocument::lineAt(float y)
+{
+    update();
+    if (m_lineHeight <= 0.0f || y <= 0.0f)
+    {
+        return 0;
+    }
+    return std::min(static_cast<size_t>(y / m_lineHeight), m_lineEnds.back() - 1);
+}
+
+size_t TextDocument::paragraphLine(size_t paragraph)
+{
+    update();
+    if (paragraph >= m_paragraphs.size())
+    {
+        throw std::out_of_range("text document paragraph is out of range");
+    }
+    return paragraph == 0 ? 0 : m_lineEnds[paragraph - 1];
+}
+
+TextBlob TextDocument::layoutVisible(float top, float height)
+{
+    update();
+
+    TextBlob blob{
+        .fontFace = m_fontFace,
+        .font = m_textStyle.font,
+        .fontEmSize = m_textStyle.size,
+        .layoutSize = {m_contentWidth, static_cast<float>(m_lineEnds.back()) * m_lineHeight},
+    };
+    if (height <= 0.0f)
+    {
+        return blob;
+    }
+
+    size_t firstLine = lineAt(top);
+    size_t lastLine = lineAt(top + height);
+    auto paragraphIndex = static_cast<size_t>(
+        std::upper_bound(m_lineEnds.begin(), m_lineEnds.end(), firstLine) - m_lineEnds.begin()
+    );
+    for (; paragraphIndex < m_paragraphs.size(); ++paragraphIndex)
+    {
+        size_t paragraphFirstLine = paragraphIndex == 0 ? 0 : m_lineEnds[paragraphIndex - 1];
+        if (paragraphFirstLine > lastLine)
+        {
+            break;
+        }
+
+        const Paragraph& paragraph = m_paragraphs[paragraphIndex];
+        size_t lineCount = paragraph.lineGlyphStarts.size() - 1;
+        size_t begin = firstLine > paragraphFirstLine ? firstLine - paragraphFirstLine : 0;
+        size_t end = std::min(lastLine - paragraphFirstLine + 1, lineCount);
+
+        // fallback faces of the paragraph, as faces of the blob
+        m_faceSlots.assign(1, 0);
+        for (const auto& fallbackFace : paragraph.fallbackFaces)
+        {
+            auto it = std::find(blob.fallbackFaces.begin(), blob.fallbackFaces.end(), fallbackFace);
+            if (it == blob.fallbackFaces.end())
+            {
+                it = blob.fallbackFaces.insert(it, fallbackFace);
+            }
+            m_faceSlots.push_back(static_cast<uint32_t>(it - blob.fallbackFaces.begin()) + 1);
+        }
+
+        float offsetY = static_cast<float>(paragraphFirstLine) * m_lineHeight;
+        for (uint32_t i = paragraph.lineGlyphStarts[begin]; i < paragraph.lineGlyphStarts[end]; ++i)
+        {
+            GlyphPosition glyph = paragraph.glyphs[i];
+            glyph.position.y += offsetY;
+            glyph.face = m_faceSlots[glyph.face];
+            blob.glyphs.push_back(glyph);
+        }
+    }
+
+    return blob;
+}
+
+void TextDocument::layoutParagraph(Paragraph& paragraph) const
+{
+    Size size{};
+    m_layouter->layout(
+        m_fontFace.get(),
+        paragraph.text,
+        m_textStyle,
+        m_paragraphStyle,
+        {m_maxWidth, 0.0f},
+        paragraph.glyphs,
+        paragraph.fallbackFaces,
+        size
+    );
+    paragraph.width = size.width;
+
+    // glyphs sit on the baselines of their lines, in order
+    auto lineOf = [this](float y)
+    {
+        return m_lineHeight > 0.0f ? static_cast<size_t>(std::max(std::lround((y - m_baseline) / m_lineHeight), 0L)) : 0;
+    };
+    paragraph.lineGlyphStarts.assign(1, 0);
+    for (uint32_t i = 0; i < paragraph.glyphs.size(); ++i)
+    {
+        size_t line = lineOf(paragraph.glyphs[i].position.y);
+        while (paragraph.lineGlyphStarts.size() <= line)
+        {
+            paragraph.lineGlyphStarts.push_back(i);
+        }
+    }
+
+    // wrapped lines without glyphs. an empty paragraph still takes a line
+    size_t lineCount = std::max({paragraph.lineGlyphStarts.size(), lineOf(size.height), size_t{1}});
+    paragraph.lineGlyphStarts.resize(lineCount + 1, static_cast<uint32_t>(paragraph.glyphs.size()));
+    paragraph.laidOut = true;
+}
+
+void TextDocument::update()
+{
+    if (!m_dirty)
+    {
+        return;
+    }
+
+    m_lineEnds.resize(m_paragraphs.size());
+    m_contentWidth = 0.0f;
+    size_t lineEnd = 0;
+    for (size_t i = 0; i < m_paragraphs.size(); ++i)
+    {
+        Paragraph& paragraph = m_paragraphs[i];
+        if (!paragraph.laidOut)
+        {
+            layoutParagraph(paragraph);
+        }
+        lineEnd += paragraph.lineGlyphStarts.size() - 1;
+        m_lineEnds[i] = lineEnd;
+        m_contentWidth = std::max(m_contentWidth, paragraph.width);
+    }
+    m_dirty = false;
+}
+
+std::pair<size_t, size_t> TextDocument::locate(size_t offset) const
+{
+    for (size_t i = 0; i < m_paragraphs.size(); ++i)
+    {
+        if (offset <= m_paragraphs[i].text.size())
+        {
+            return {i, offset};
+        }
+        // and the '\n' after the paragraph
+        offset -= m_paragraphs[i].text.size() + 1;
+    }
+    throw std::out_of_range("text document offset is out of range");
+}
+} // karin
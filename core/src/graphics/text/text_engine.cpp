@@ -20,4 +20,39 @@ TextBlob TextEngine::layoutText(
 {
     return m_impl->layoutText(text, textStyle, paragraphStyle, maxSize);
 }
+
+std::future<TextBlob> TextEngine::layoutTextAsync(
+    std::string text,
+    const TextStyle& textStyle,
+    const ParagraphStyle& paragraphStyle,
+    const Size& maxSize
+)
+{
+    return m_impl->layoutTextAsync(std::move(text), textStyle, paragraphStyle, maxSize);
+}
+
+Size TextEngine::measureText(
+    const std::string& text,
+    const TextStyle& textStyle,
+    const ParagraphStyle& paragraphStyle,
+    const Size& maxSize
+)
+{
+    return m_impl->measureText(text, textStyle, paragraphStyle, maxSize);
+}
+
+TextGrid TextEngine::createTextGrid(uint32_t columns, uint32_t rows, const TextStyle& textStyle)
+{
+    return m_impl->createTextGrid(columns, rows, textStyle);
+}
+
+TextDocument TextEngine::createTextDocument(
+    std::string_view text,
+    const TextStyle& textStyle,
+    const ParagraphStyle& paragraphStyle,
+    float maxWidth
+)
+{
+    return m_impl->createTextDocument(text, textStyle, paragraphStyle, maxWidth);
+}
 }
@@ -1,11 +1,30 @@
 #include "text_engine_impl.h"
 
+#include "harfbuzz_provider.h"
+
+#include <utils/hash.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
 namespace karin
 {
+size_t TextEngineImpl::MeasureKeyHash::operator()(const MeasureKey& key) const
+{
+    size_t seed = 0;
+    hash_combine(seed, key.text);
+    hash_combine(seed, key.textStyleHash);
+    hash_combine(seed, key.paragraphStyleHash);
+    hash_combine(seed, key.maxWidth);
+    return seed;
+}
+
 TextEngineImpl::TextEngineImpl()
 {
     m_fontLoader = std::make_unique<FontLoader>();
-    m_textLayouter = std::make_unique<TextLayouter>();
+    m_textLayouter = std::make_shared<TextLayouter>(ShapeCache::DEFAULT_BYTE_BUDGET, m_fontLoader.get());
+    m_workerPool = std::make_unique<LayoutWorkerPool>();
 }
 
 TextBlob TextEngineImpl::layoutText(
@@ -15,15 +34,19 @@ TextBlob TextEngineImpl::layoutText(
     const Size& maxSize
 ) const
 {
-    std::unique_ptr<IFontFace> fontFace = m_fontLoader->loadFont(textStyle.font);
+    std::shared_ptr<IFontFace> fontFace = m_fontLoader->loadFont(textStyle.font);
 
     Size layoutSize{};
-    std::vector<GlyphPosition> glyphs = TextLayouter::layout(
+    std::vector<GlyphPosition> glyphs;
+    std::vector<std::shared_ptr<IFontFace>> fallbackFaces;
+    m_textLayouter->layout(
         fontFace.get(),
         text,
         textStyle,
         paragraphStyle,
         maxSize,
+        glyphs,
+        fallbackFaces,
         layoutSize
     );
 
@@ -33,6 +56,99 @@ TextBlob TextEngineImpl::layoutText(
         .font = textStyle.font,
         .fontEmSize = textStyle.size,
         .layoutSize = layoutSize,
+        .fallbackFaces = std::move(fallbackFaces),
+    };
+}
+
+std::future<TextBlob> TextEngineImpl::layoutTextAsync(
+    std::string text,
+    const TextStyle& textStyle,
+    const ParagraphStyle& paragraphStyle,
+    const Size& maxSize
+) const
+{
+    // font loader, shape cache and faces are shared between threads. the shaping buffers are per thread
+    return m_workerPool->submit(
+        [this, text = std::move(text), textStyle, paragraphStyle, maxSize]
+        {
+            return layoutText(text, textStyle, paragraphStyle, maxSize);
+        }
+    );
+}
+
+Size TextEngineImpl::measureText(
+    const std::string& text,
+    const TextStyle& textStyle,
+    const ParagraphStyle& paragraphStyle,
+    const Size& maxSize
+) const
+{
+    MeasureKey key{
+        .text = text,
+        .textStyleHash = textStyle.hash(),
+        .paragraphStyleHash = paragraphStyle.hash(),
+        .maxWidth = maxSize.width,
+    };
+    {
+        std::lock_guard lock(m_measurementsMutex);
+        if (auto it = m_measurements.find(key); it != m_measurements.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::shared_ptr<IFontFace> fontFace = m_fontLoader->loadFont(textStyle.font);
+    Size size = m_textLayouter->measure(fontFace.get(), text, textStyle, paragraphStyle, maxSize);
+
+    std::lock_guard lock(m_measurementsMutex);
+    if (m_measurements.size() >= MAX_CACHED_MEASUREMENTS)
+    {
+        m_measurements.clear();
+    }
+    m_measurements.emplace(std::move(key), size);
+    return size;
+}
+
+TextGrid TextEngineImpl::createTextGrid(uint32_t columns, uint32_t rows, const TextStyle& textStyle) const
+{
+    std::shared_ptr<IFontFace> fontFace = m_fontLoader->loadFont(textStyle.font);
+    auto hbProvider = dynamic_cast<const IHarfBuzzProvider*>(fontFace.get());
+    if (!hbProvider)
+    {
+        throw std::runtime_error("FontFace must implement IHarfBuzzProvider");
+    }
+
+    FontMetrics fontMetrics = fontFace->getFontMetrics();
+    float scale = textStyle.size / static_cast<float>(fontMetrics.unitsPerEm);
+
+    // every glyph of a monospace font has this advance
+    hb_codepoint_t glyph = 0;
+    hb_font_get_nominal_glyph(hbProvider->getHbFont(), 'M', &glyph);
+    float advance = fontFace->getGlyphMetrics(glyph).advanceX * scale;
+
+    float ascender = static_cast<float>(fontMetrics.ascender) * scale;
+    float lineHeight = static_cast<float>(fontMetrics.ascender + fontMetrics.descender + fontMetrics.lineGap) * scale;
+
+    TextGridMetrics metrics{
+        .cellSize = {std::ceil(advance), std::ceil(lineHeight)},
+        .baseline = std::round(ascender + static_cast<float>(fontMetrics.lineGap) * scale / 2.0f),
+        .underlinePosition = -static_cast<float>(fontMetrics.underlinePosition) * scale,
+        .underlineThickness = std::max(static_cast<float>(fontMetrics.underlineThickness) * scale, 1.0f),
+        .lineThroughPosition = -static_cast<float>(fontMetrics.strikethroughPosition) * scale,
+        .lineThroughThickness = std::max(static_cast<float>(fontMetrics.strikethroughThickness) * scale, 1.0f),
     };
+
+    return TextGrid(columns, rows, std::move(fontFace), textStyle.font, textStyle.size, metrics);
+}
+
+TextDocument TextEngineImpl::createTextDocument(
+    std::string_view text,
+    const TextStyle& textStyle,
+    const ParagraphStyle& paragraphStyle,
+    float maxWidth
+) const
+{
+    std::shared_ptr<IFontFace> fontFace = m_fontLoader->loadFont(textStyle.font);
+    return TextDocument(text, textStyle, paragraphStyle, maxWidth, std::move(fontFace), m_textLayouter);
 }
 }
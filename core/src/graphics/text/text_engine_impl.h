@@ -2,12 +2,20 @@
 #define SRC_GRAPHICS_TEXT_TEXT_ENGINE_IMPL_H
 
 #include <karin/graphics/text_blob.h>
+#include <karin/graphics/text_document.h>
+#include <karin/graphics/text_grid.h>
 #include <karin/graphics/text_style.h>
 #include <karin/graphics/paragraph_style.h>
 
 #include "font_loader.h"
+#include "layout_worker_pool.h"
 #include "text_layouter.h"
 
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 namespace karin
 {
 class TextEngineImpl
@@ -23,9 +31,58 @@ public:
         const Size& maxSize
     ) const;
 
+    std::future<TextBlob> layoutTextAsync(
+        std::string text,
+        const TextStyle& textStyle,
+        const ParagraphStyle& paragraphStyle,
+        const Size& maxSize
+    ) const;
+
+    Size measureText(
+        const std::string& text,
+        const TextStyle& textStyle,
+        const ParagraphStyle& paragraphStyle,
+        const Size& maxSize
+    ) const;
+
+    TextGrid createTextGrid(uint32_t columns, uint32_t rows, const TextStyle& textStyle) const;
+
+    TextDocument createTextDocument(
+        std::string_view text,
+        const TextStyle& textStyle,
+        const ParagraphStyle& paragraphStyle,
+        float maxWidth
+    ) const;
+
 private:
+    struct MeasureKey
+    {
+        std::string text;
+        size_t textStyleHash;
+        size_t paragraphStyleHash;
+        // the layout does not depend on the height
+        float maxWidth;
+
+        bool operator==(const MeasureKey& other) const = default;
+    };
+
+    struct MeasureKeyHash
+    {
+        size_t operator()(const MeasureKey& key) const;
+    };
+
+    // cleared when full, like the measurements of TextNode
+    static constexpr size_t MAX_CACHED_MEASUREMENTS = 1024;
+
     std::unique_ptr<FontLoader> m_fontLoader;
-    std::unique_ptr<TextLayouter> m_textLayouter;
+    // shared with the documents, so they keep using the shape cache
+    std::shared_ptr<TextLayouter> m_textLayouter;
+
+    mutable std::mutex m_measurementsMutex;
+    mutable std::unordered_map<MeasureKey, Size, MeasureKeyHash> m_measurements;
+
+    // last, so that its workers stop before the members they use are destroyed
+    std::unique_ptr<LayoutWorkerPool> m_workerPool;
 };
 }
 
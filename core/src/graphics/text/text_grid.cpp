@@ -0,0 +1,213 @@
+#include <karin/graphics/text_grid.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+namespace
+{
+std::atomic<uint64_t> nextGridId = 1;
+std::atomic<uint64_t> nextSlotVersion = 1;
+
+// U+FFFD for malformed sequences. index is moved past the code point
+char32_t decodeUtf8(std::string_view text, size_t& index)
+{
+    auto c = static_cast<unsigned char>(text[index++]);
+    if (c < 0x80)
+    {
+        return c;
+    }
+
+    int length;
+    char32_t codepoint;
+    if ((c & 0xE0) == 0xC0) // starts with 110
+    {
+        length = 1;
+        codepoint = c & 0x1F;
+    }
+    else if ((c & 0xF0) == 0xE0) // starts with 1110
+    {
+        length = 2;
+        codepoint = c & 0x0F;
+    }
+    else if ((c & 0xF8) == 0xF0) // starts with 11110
+    {
+        length = 3;
+        codepoint = c & 0x07;
+    }
+    else
+    {
+        return U'\uFFFD';
+    }
+
+    for (int i = 0; i < length; ++i)
+    {
+        if (index >= text.size() || (static_cast<unsigned char>(text[index]) & 0xC0) != 0x80)
+        {
+            return U'\uFFFD';
+        }
+        codepoint = (codepoint << 6) | (static_cast<unsigned char>(text[index++]) & 0x3F);
+    }
+    return codepoint;
+}
+}
+
+namespace karin
+{
+TextGrid::TextGrid(
+    uint32_t columns, uint32_t rows, std::shared_ptr<IFontFace> fontFace, Font font, float fontEmSize,
+    const TextGridMetrics& metrics
+)
+    : m_id(nextGridId++),
+      m_fontFace(std::move(fontFace)),
+      m_font(std::move(font)),
+      m_fontEmSize(fontEmSize),
+      m_metrics(metrics)
+{
+    resize(columns, rows);
+}
+
+const TextGridCell& TextGrid::cell(uint32_t column, uint32_t row) const
+{
+    if (column >= m_columns || row >= m_rows)
+    {
+        throw std::out_of_range("text grid cell is out of range");
+    }
+    return m_cells[static_cast<size_t>(m_rowSlots[row]) * m_columns + column];
+}
+
+void TextGrid::setCell(uint32_t column, uint32_t row, const TextGridCell& cell)
+{
+    if (column >= m_columns || row >= m_rows)
+    {
+        throw std::out_of_range("text grid cell is out of range");
+    }
+
+    TextGridCell& target = rowData(row)[column];
+    if (target != cell)
+    {
+        target = cell;
+        touchRow(row);
+    }
+}
+
+uint32_t TextGrid::setText(uint32_t column, uint32_t row, std::string_view text, const TextGridCell& style)
+{
+    if (row >= m_rows)
+    {
+        throw std::out_of_range("text grid row is out of range");
+    }
+
+    TextGridCell* cells = rowData(row);
+    TextGridCell cell = style;
+    bool changed = false;
+    uint32_t written = 0;
+    for (size_t index = 0; index < text.size() && column < m_columns; ++column, ++written)
+    {
+        cell.codepoint = decodeUtf8(text, index);
+        changed = changed || cells[column] != cell;
+        cells[column] = cell;
+    }
+
+    if (changed)
+    {
+        touchRow(row);
+    }
+    return written;
+}
+
+void TextGrid::fillRow(uint32_t row, const TextGridCell& cell)
+{
+    if (row >= m_rows)
+    {
+        throw std::out_of_range("text grid row is out of range");
+    }
+
+    std::fill_n(rowData(row), m_columns, cell);
+    touchRow(row);
+}
+
+void TextGrid::clear(const TextGridCell& cell)
+{
+    for (uint32_t row = 0; row < m_rows; ++row)
+    {
+        fillRow(row, cell);
+    }
+}
+
+void TextGrid::scroll(int32_t count, const TextGridCell& cell)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    uint32_t distance = std::min<uint32_t>(count > 0 ? count : -count, m_rows);
+    if (count > 0)
+    {
+        std::rotate(m_rowSlots.begin(), m_rowSlots.begin() + distance, m_rowSlots.end());
+        for (uint32_t row = m_rows - distance; row < m_rows; ++row)
+        {
+            fillRow(row, cell);
+        }
+    }
+    else
+    {
+        std::rotate(m_rowSlots.rbegin(), m_rowSlots.rbegin() + distance, m_rowSlots.rend());
+        for (uint32_t row = 0; row < distance; ++row)
+        {
+            fillRow(row, cell);
+        }
+    }
+}
+
+void TextGrid::resize(uint32_t columns, uint32_t rows, const TextGridCell& cell)
+{
+    std::vector<TextGridCell> cells(static_cast<size_t>(columns) * rows, cell);
+    for (uint32_t row = 0; row < std::min(rows, m_rows); ++row)
+    {
+        std::span<const TextGridCell> source = this->row(row);
+        std::copy_n(source.begin(), std::min(columns, m_columns), cells.begin() + static_cast<size_t>(row) * columns);
+    }
+
+    m_columns = columns;
+    m_rows = rows;
+    m_cells = std::move(cells);
+    m_rowSlots.resize(rows);
+    m_slotVersions.resize(rows);
+    for (uint32_t row = 0; row < rows; ++row)
+    {
+        m_rowSlots[row] = row;
+        m_slotVersions[row] = nextSlotVersion++;
+    }
+}
+
+std::span<const TextGridCell> TextGrid::row(uint32_t row) const
+{
+    if (row >= m_rows)
+    {
+        throw std::out_of_range("text grid row is out of range");
+    }
+    return {m_cells.data() + static_cast<size_t>(m_rowSlots[row]) * m_columns, m_columns};
+}
+
+uint32_t TextGrid::rowSlot(uint32_t row) const
+{
+    return m_rowSlots[row];
+}
+
+uint64_t TextGrid::slotVersion(uint32_t slot) const
+{
+    return m_slotVersions[slot];
+}
+
+TextGridCell* TextGrid::rowData(uint32_t row)
+{
+    return m_cells.data() + static_cast<size_t>(m_rowSlots[row]) * m_columns;
+}
+
+void TextGrid::touchRow(uint32_t row)
+{
+    m_slotVersions[m_rowSlots[row]] = nextSlotVersion++;
+}
+} // karin
@@ -1,13 +1,14 @@
 #include "text_layouter.h"
 
-#include <ft2build.h>
-#include FT_FREETYPE_H
 #include <harfbuzz/hb.h>
 
-#include <ranges>
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "font_coverage.h"
+#include "font_loader.h"
 #include "harfbuzz_provider.h"
 
 namespace
@@ -67,14 +68,14 @@ float calculateBaseLine(
     }
 }
 
-uint32_t getCodepoint(const std::string& text, size_t index)
+uint32_t getCodepoint(std::string_view text, size_t index)
 {
     if (index >= text.size())
     {
         return 0xFFFD;
     }
 
-    const auto *str = reinterpret_cast<const unsigned char*>(text.c_str());
+    const auto *str = reinterpret_cast<const unsigned char*>(text.data());
     unsigned char c = str[index];
     if (c < 0x80)
     {
@@ -99,6 +100,91 @@ uint32_t getCodepoint(const std::string& text, size_t index)
     return 0;
 }
 
+// U+FFFD for malformed sequences. index is moved past the code point
+char32_t nextCodepoint(std::string_view text, size_t& index)
+{
+    auto c = static_cast<unsigned char>(text[index]);
+    size_t length = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+    if (length == 0 || index + length > text.size())
+    {
+        ++index;
+        return 0xFFFD;
+    }
+
+    char32_t codepoint = getCodepoint(text, index);
+    index += length;
+    return codepoint;
+}
+
+// controls are never looked up in fallback fonts
+bool isCovered(const FontCoverage::Block* block, char32_t codepoint)
+{
+    return codepoint < 0x20 || (block && FontCoverage::contains(*block, codepoint));
+}
+
+bool coversText(const FontCoverage& coverage, std::string_view text)
+{
+    uint32_t lastBlock = UINT32_MAX;
+    const FontCoverage::Block* block = nullptr;
+    for (size_t index = 0; index < text.size();)
+    {
+        char32_t codepoint = nextCodepoint(text, index);
+        if (codepoint / FontCoverage::BLOCK_SIZE != lastBlock)
+        {
+            lastBlock = codepoint / FontCoverage::BLOCK_SIZE;
+            block = coverage.block(lastBlock);
+        }
+        if (!isCovered(block, codepoint))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isWeakScript(hb_script_t script)
+{
+    return script == HB_SCRIPT_COMMON || script == HB_SCRIPT_INHERITED || script == HB_SCRIPT_UNKNOWN;
+}
+
+// byte range of a line shaped with one face
+struct LineRun
+{
+    size_t start;
+    size_t end;
+    uint32_t face;
+};
+
+// per thread, so that layouts on different threads do not share them
+struct ShapingScratch
+{
+    hb_buffer_t* buffer = hb_buffer_create();
+    // shaped glyphs of the last line that was not found in the cache
+    ShapedRun run;
+    // keeps the last run found in the cache alive
+    std::shared_ptr<const ShapedRun> cachedRun;
+
+    // glyphs of the last itemized line, with clusters from the line start, and the face of each
+    std::vector<ShapedGlyph> lineGlyphs;
+    std::vector<uint32_t> lineFaces;
+    std::vector<LineRun> runs;
+
+    ShapingScratch() = default;
+    ShapingScratch(const ShapingScratch&) = delete;
+    ShapingScratch& operator=(const ShapingScratch&) = delete;
+
+    ~ShapingScratch()
+    {
+        hb_buffer_destroy(buffer);
+    }
+};
+
+ShapingScratch& shapingScratch()
+{
+    thread_local ShapingScratch scratch;
+    return scratch;
+}
+
 // TODO: breakable has two pattern:
 // 1. spaces: don't rendered at first of new line
 // 2. CJK characters: need to be rendered at first of new line
@@ -121,24 +207,58 @@ bool isBreakable(uint32_t codepoint)
 
 namespace karin
 {
-std::vector<GlyphPosition> TextLayouter::layout(
+struct TextLayouter::LayoutFace
+{
+    const IFontFace* face;
+    hb_font_t* hbFont;
+    const FontCoverage* coverage;
+    const SimpleShaper* simpleShaper;
+    float scale;
+    // fallback faces only. the requested face is kept alive by the caller
+    std::shared_ptr<IFontFace> owner;
+};
+
+TextLayouter::TextLayouter(size_t shapeCacheByteBudget, FontLoader* fallbackLoader)
+    : m_shapeCache(shapeCacheByteBudget),
+      m_fallbackLoader(fallbackLoader)
+{
+}
+
+void TextLayouter::layout(
     const IFontFace* face,
-    const std::string& text,
+    std::string_view text,
     const TextStyle& textStyle,
     const ParagraphStyle& paragraphStyle,
     const Size& maxSize,
+    std::vector<GlyphPosition>& outGlyphs,
+    std::vector<std::shared_ptr<IFontFace>>& outFallbackFaces,
     Size& outContentSize
 )
 {
-    std::vector<std::string> lines = std::views::split(text, '\n')
-        | std::views::transform(
-            [](auto&& rng)
-            {
-                return std::string(rng.begin(), rng.end());
-            }
-        )
-        | std::ranges::to<std::vector<std::string>>();
+    outContentSize = layoutLines(face, text, textStyle, paragraphStyle, maxSize, &outGlyphs, &outFallbackFaces);
+}
 
+Size TextLayouter::measure(
+    const IFontFace* face,
+    std::string_view text,
+    const TextStyle& textStyle,
+    const ParagraphStyle& paragraphStyle,
+    const Size& maxSize
+)
+{
+    return layoutLines(face, text, textStyle, paragraphStyle, maxSize, nullptr, nullptr);
+}
+
+Size TextLayouter::layoutLines(
+    const IFontFace* face,
+    std::string_view text,
+    const TextStyle& textStyle,
+    const ParagraphStyle& paragraphStyle,
+    const Size& maxSize,
+    std::vector<GlyphPosition>* outGlyphs,
+    std::vector<std::shared_ptr<IFontFace>>* outFallbackFaces
+)
+{
     auto hbProvider = dynamic_cast<const IHarfBuzzProvider*>(face);
     if (!hbProvider)
     {
@@ -148,72 +268,93 @@ std::vector<GlyphPosition> TextLayouter::layout(
     hb_font_t* hbFont = hbProvider->getHbFont();
 
     FontMetrics fontMetrics = face->getFontMetrics();
-    std::vector<GlyphPosition> glyphs;
+    // measuring places no glyphs, only moves the pen
+    auto popGlyphs = [outGlyphs](size_t count)
+    {
+        if (outGlyphs)
+        {
+            outGlyphs->resize(outGlyphs->size() - count);
+        }
+    };
+    if (outGlyphs)
+    {
+        outGlyphs->clear();
+        // at most one glyph per byte in practice
+        outGlyphs->reserve(text.size());
+    }
+
+    // the lines of a text too large for the cache would only evict each other
+    bool useCache = text.size() * sizeof(ShapedGlyph) <= m_shapeCache.byteBudget() / 2;
+    // the simple shaper lays out left to right only
+    const SimpleShaper* simpleShaper = paragraphStyle.readingDirection == ParagraphStyle::Direction::LEFT_TO_RIGHT
+        ? SimpleShaper::forFont(hbFont, textStyle.locale)
+        : nullptr;
 
     float initPenX = 0;
     float scale = textStyle.size / static_cast<float>(fontMetrics.unitsPerEm);
-    float lineHeight = calculateLineHeight(
-        paragraphStyle.lineSpacing,
-        paragraphStyle.lineSpacingMode,
-        textStyle.size,
-        static_cast<float>(fontMetrics.capHeight) * scale
-    );
-    float penY = calculateBaseLine(
-        paragraphStyle.baseline,
-        paragraphStyle.lineSpacingMode,
-        textStyle.size,
-        static_cast<float>(fontMetrics.capHeight) * scale
-    );
+    // slot 0 is the requested face, the fallbacks follow in the order they are first needed
+    std::vector<LayoutFace> faces{{
+        .face = face,
+        .hbFont = hbFont,
+        .coverage = m_fallbackLoader ? &FontCoverage::forFont(hbFont) : nullptr,
+        .simpleShaper = simpleShaper,
+        .scale = scale,
+    }};
+    LineMetrics lineMetrics = TextLayouter::lineMetrics(face, textStyle, paragraphStyle);
+    float lineHeight = lineMetrics.lineHeight;
+    float penY = lineMetrics.baseline;
     float penX = 0;
     float maxX = 0;
 
-    for (const auto& line : lines)
+    // same lines as splitting on '\n': "a\n" ends with an empty line, "" has no line
+    for (size_t lineStart = 0; !text.empty() && lineStart <= text.size();)
     {
-        hb_buffer_t* hbBuffer = hb_buffer_create();
-        hb_buffer_add_utf8(hbBuffer, line.c_str(), -1, 0, -1);
-        hb_buffer_set_direction(hbBuffer, toHBDirection(paragraphStyle.readingDirection));
-        hb_buffer_set_language(hbBuffer, hb_language_from_string(textStyle.locale.c_str(), -1));
-
-        hb_shape(hbFont, hbBuffer, nullptr, 0);
-
-        uint32_t glyphCount = 0;
-        hb_glyph_info_t* glyphInfo = hb_buffer_get_glyph_infos(hbBuffer, &glyphCount);
-        hb_glyph_position_t* glyphPos = hb_buffer_get_glyph_positions(hbBuffer, &glyphCount);
-
-        std::vector<GlyphMetrics> metricsList;
-        metricsList.reserve(glyphCount);
-        for (uint32_t i = 0; i < glyphCount; i++)
+        size_t lineEnd = std::min(text.find('\n', lineStart), text.size());
+        std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        // nullptr: every glyph is from the requested face
+        const std::vector<uint32_t>* glyphFaces = nullptr;
+        const std::vector<ShapedGlyph>* shapedGlyphs;
+        if (!m_fallbackLoader || coversText(*faces[0].coverage, line))
         {
-            FT_UInt glyphIndex = glyphInfo[i].codepoint;
-
-            auto metrics = face->getGlyphMetrics(glyphIndex);
-            metrics.advanceX = metrics.advanceX * scale;
-            metrics.bearingX = metrics.bearingX * scale;
-            metrics.bearingY = metrics.bearingY * scale;
-            metrics.width = metrics.width * scale;
-            metrics.height = metrics.height * scale;
-
-            metricsList.push_back(metrics);
+            shapedGlyphs = &shapeLine(
+                hbFont, line, paragraphStyle.readingDirection, textStyle.locale, simpleShaper, useCache
+            ).glyphs;
         }
+        else
+        {
+            shapeItemizedLine(line, textStyle, paragraphStyle.readingDirection, faces, useCache);
+            shapedGlyphs = &shapingScratch().lineGlyphs;
+            glyphFaces = &shapingScratch().lineFaces;
+        }
+        const std::vector<ShapedGlyph>& shaped = *shapedGlyphs;
+        auto glyphCount = static_cast<uint32_t>(shaped.size());
 
         uint32_t lastSpaceIndex = 0;
         for (uint32_t i = 0; i < glyphCount; i++)
         {
-            if (isBreakable(getCodepoint(line, glyphInfo[i].cluster)))
+            if (isBreakable(getCodepoint(line, shaped[i].cluster)))
             {
                 lastSpaceIndex = i;
             }
 
-            Point position = {
-                penX + metricsList[i].bearingX,
-                penY,
-            };
-
-            glyphs.push_back(GlyphPosition{
-                .position = position,
-                .glyphIndex = metricsList[i].glyphIndex,
-            });
-            penX += static_cast<float>(glyphPos[i].x_advance) * scale;
+            uint32_t faceSlot = glyphFaces ? (*glyphFaces)[i] : 0;
+            const LayoutFace& glyphFace = faces[faceSlot];
+            if (outGlyphs)
+            {
+                Point position = {
+                    penX + glyphFace.face->getGlyphMetrics(shaped[i].glyphIndex).bearingX * glyphFace.scale,
+                    penY,
+                };
+
+                outGlyphs->push_back(GlyphPosition{
+                    .position = position,
+                    .glyphIndex = shaped[i].glyphIndex,
+                    .face = faceSlot,
+                });
+            }
+            penX += static_cast<float>(shaped[i].advanceX) * glyphFace.scale;
 
             if (maxSize.width > 0 && penX > maxSize.width)
             {
@@ -223,17 +364,13 @@ std::vector<GlyphPosition> TextLayouter::layout(
                 {
                     if (paragraphStyle.trimming == ParagraphStyle::Trimming::CHARACTER)
                     {
-                        glyphs.pop_back();
+                        popGlyphs(1);
                         break;
                     }
 
                     if (paragraphStyle.trimming == ParagraphStyle::Trimming::WORD && lastSpaceIndex != 0)
                     {
-                        for (uint32_t j = i; j > lastSpaceIndex; j--)
-                        {
-                            glyphs.pop_back();
-                        }
-                        glyphs.pop_back();
+                        popGlyphs(i - lastSpaceIndex + 1);
                         break;
                     }
                 }
@@ -241,17 +378,14 @@ std::vector<GlyphPosition> TextLayouter::layout(
                 {
                     penX = initPenX;
                     penY += lineHeight;
-                    glyphs.pop_back();
+                    popGlyphs(1);
                     i--;
                 }
                 else if (paragraphStyle.wrapping == ParagraphStyle::Wrapping::WORD && lastSpaceIndex != 0)
                 {
                     penX = initPenX;
                     penY += lineHeight;
-                    for (uint32_t j = i; j >= lastSpaceIndex; j--)
-                    {
-                        glyphs.pop_back();
-                    }
+                    popGlyphs(i - lastSpaceIndex + 1);
                     // TODO: change depend on breakable character type. Now: all rendered at first of new line.
                     i = lastSpaceIndex - 1;
                     lastSpaceIndex = 0;
@@ -259,19 +393,217 @@ std::vector<GlyphPosition> TextLayouter::layout(
             }
         }
 
-        hb_buffer_destroy(hbBuffer);
-
         maxX = std::max(maxX, penX);
 
         penX = initPenX;
         penY += lineHeight;
     }
 
-    outContentSize = {
+    if (outFallbackFaces)
+    {
+        outFallbackFaces->clear();
+        for (size_t slot = 1; slot < faces.size(); ++slot)
+        {
+            outFallbackFaces->push_back(std::move(faces[slot].owner));
+        }
+    }
+
+    return {
         .width = maxX,
         .height = penY,
     };
+}
+
+TextLayouter::LineMetrics TextLayouter::lineMetrics(
+    const IFontFace* face, const TextStyle& textStyle, const ParagraphStyle& paragraphStyle
+)
+{
+    FontMetrics fontMetrics = face->getFontMetrics();
+    float scale = textStyle.size / static_cast<float>(fontMetrics.unitsPerEm);
+    float capHeight = static_cast<float>(fontMetrics.capHeight) * scale;
+
+    return {
+        .baseline = calculateBaseLine(paragraphStyle.baseline, paragraphStyle.lineSpacingMode, textStyle.size, capHeight),
+        .lineHeight = calculateLineHeight(paragraphStyle.lineSpacing, paragraphStyle.lineSpacingMode, textStyle.size, capHeight),
+    };
+}
+
+ShapeCache& TextLayouter::shapeCache()
+{
+    return m_shapeCache;
+}
+
+void TextLayouter::shapeItemizedLine(
+    std::string_view line,
+    const TextStyle& textStyle,
+    ParagraphStyle::Direction direction,
+    std::vector<LayoutFace>& faces,
+    bool useCache
+)
+{
+    ShapingScratch& scratch = shapingScratch();
+    hb_unicode_funcs_t* unicodeFuncs = hb_unicode_funcs_get_default();
+
+    // the first face covering the code point: the requested face, a fallback already in use, then a new fallback
+    auto faceFor = [&](char32_t codepoint) -> uint32_t
+    {
+        for (uint32_t slot = 0; slot < faces.size(); ++slot)
+        {
+            if (isCovered(faces[slot].coverage->block(codepoint / FontCoverage::BLOCK_SIZE), codepoint))
+            {
+                return slot;
+            }
+        }
+
+        std::shared_ptr<IFontFace> fallback = m_fallbackLoader->loadFallbackFont(textStyle.font, codepoint);
+        auto hbProvider = dynamic_cast<const IHarfBuzzProvider*>(fallback.get());
+        if (!hbProvider || fallback.get() == faces[0].face)
+        {
+            // notdef of the requested face
+            return 0;
+        }
+
+        hb_font_t* hbFont = hbProvider->getHbFont();
+        faces.push_back({
+            .face = fallback.get(),
+            .hbFont = hbFont,
+            .coverage = &FontCoverage::forFont(hbFont),
+            .simpleShaper = direction == ParagraphStyle::Direction::LEFT_TO_RIGHT
+                ? SimpleShaper::forFont(hbFont, textStyle.locale)
+                : nullptr,
+            .scale = textStyle.size / static_cast<float>(fallback->getFontMetrics().unitsPerEm),
+            .owner = std::move(fallback),
+        });
+        return static_cast<uint32_t>(faces.size() - 1);
+    };
+
+    // runs break where the face or the script changes. punctuation, spaces and combining marks stay in the
+    // current run while its face covers them, so they do not split a run of another script
+    std::vector<LineRun>& runs = scratch.runs;
+    runs.clear();
+    hb_script_t runScript = HB_SCRIPT_COMMON;
+    for (size_t index = 0; index < line.size();)
+    {
+        size_t start = index;
+        char32_t codepoint = nextCodepoint(line, index);
+        hb_script_t script = hb_unicode_script(unicodeFuncs, codepoint);
+        bool weak = isWeakScript(script);
+
+        bool fitsRun = !runs.empty() && (weak || isWeakScript(runScript) || script == runScript);
+        if (fitsRun && (script == HB_SCRIPT_INHERITED
+            || isCovered(faces[runs.back().face].coverage->block(codepoint / FontCoverage::BLOCK_SIZE), codepoint)))
+        {
+            runs.back().end = index;
+        }
+        else if (uint32_t face = faceFor(codepoint); fitsRun && runs.back().face == face)
+        {
+            // not covered by any face either
+            runs.back().end = index;
+        }
+        else
+        {
+            runs.push_back({.start = start, .end = index, .face = face});
+            runScript = HB_SCRIPT_COMMON;
+        }
+
+        if (!weak)
+        {
+            runScript = script;
+        }
+    }
+
+    // the pen moves left to right, so the last run of a right-to-left line comes first
+    if (direction == ParagraphStyle::Direction::RIGHT_TO_LEFT)
+    {
+        std::reverse(runs.begin(), runs.end());
+    }
+
+    scratch.lineGlyphs.clear();
+    scratch.lineFaces.clear();
+    for (const LineRun& run : runs)
+    {
+        const LayoutFace& face = faces[run.face];
+        const ShapedRun& shaped = shapeLine(
+            face.hbFont, line.substr(run.start, run.end - run.start), direction, textStyle.locale,
+            face.simpleShaper, useCache
+        );
+        for (ShapedGlyph glyph : shaped.glyphs)
+        {
+            glyph.cluster += static_cast<uint32_t>(run.start);
+            scratch.lineGlyphs.push_back(glyph);
+            scratch.lineFaces.push_back(run.face);
+        }
+    }
+}
+
+const ShapedRun& TextLayouter::shapeLine(
+    hb_font_t* hbFont,
+    std::string_view line,
+    ParagraphStyle::Direction direction,
+    const std::string& language,
+    const SimpleShaper* simpleShaper,
+    bool useCache
+)
+{
+    ShapingScratch& scratch = shapingScratch();
+
+    // plain Latin text in a font without shaping lookups is cheaper to shape than to look up
+    if (simpleShaper && simpleShaper->shape(line, scratch.run.glyphs))
+    {
+        return scratch.run;
+    }
+
+    // the hb font is scaled to units per em, so shaped runs do not depend on the font size
+    ShapeCache::Key key{
+        .text = line,
+        .font = hbFont,
+        .direction = static_cast<uint8_t>(direction),
+        .language = language,
+    };
+    if (useCache)
+    {
+        if (auto run = m_shapeCache.find(key))
+        {
+            scratch.cachedRun = std::move(run);
+            return *scratch.cachedRun;
+        }
+    }
+
+    hb_buffer_t* hbBuffer = scratch.buffer;
+    hb_buffer_clear_contents(hbBuffer);
+    hb_buffer_add_utf8(hbBuffer, line.data(), static_cast<int>(line.size()), 0, static_cast<int>(line.size()));
+    hb_buffer_set_direction(hbBuffer, toHBDirection(direction));
+    hb_buffer_set_language(hbBuffer, hb_language_from_string(language.c_str(), -1));
+    // the script of the text, so that runs of any script get their script's shaping
+    hb_buffer_guess_segment_properties(hbBuffer);
+
+    hb_shape(hbFont, hbBuffer, nullptr, 0);
+
+    uint32_t glyphCount = 0;
+    hb_glyph_info_t* glyphInfo = hb_buffer_get_glyph_infos(hbBuffer, &glyphCount);
+    hb_glyph_position_t* glyphPos = hb_buffer_get_glyph_positions(hbBuffer, &glyphCount);
+
+    ShapedRun& run = scratch.run;
+    run.glyphs.clear();
+    for (uint32_t i = 0; i < glyphCount; i++)
+    {
+        run.glyphs.push_back(ShapedGlyph{
+            .glyphIndex = glyphInfo[i].codepoint,
+            .cluster = glyphInfo[i].cluster,
+            .advanceX = glyphPos[i].x_advance,
+        });
+    }
+
+    if (useCache)
+    {
+        // the entry holds a reference so the hb font address stays unique while cached
+        m_shapeCache.insert(
+            key,
+            std::shared_ptr<hb_font_t>(hb_font_reference(hbFont), hb_font_destroy),
+            std::make_shared<ShapedRun>(run)
+        );
+    }
 
-    return glyphs;
+    return run;
 }
-} // karin
\ No newline at end of file
+} // karin
@@ -7,25 +7,100 @@
 #include <karin/graphics/font_face.h>
 #include <karin/graphics/text_blob.h>
 
+#include "font_loader.h"
+#include "shape_cache.h"
+#include "simple_shaper.h"
+
+#include <hb.h>
+
+#include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
 
 namespace karin
 {
 class TextLayouter
 {
 public:
-    TextLayouter() = default;
+    // every line of a layout has the same metrics. pixels
+    struct LineMetrics
+    {
+        // of the first line, from the top of the layout
+        float baseline;
+        // distance between the baselines of consecutive lines
+        float lineHeight;
+    };
+
+    // fallbackLoader: finds faces for the code points the requested face does not cover. nullptr for no fallback
+    explicit TextLayouter(
+        size_t shapeCacheByteBudget = ShapeCache::DEFAULT_BYTE_BUDGET, FontLoader* fallbackLoader = nullptr
+    );
     ~TextLayouter() = default;
 
-    static std::vector<GlyphPosition> layout(
+    // outGlyphs is cleared and refilled, so a caller that keeps it between layouts reuses its capacity.
+    // GlyphPosition::face n > 0 refers to outFallbackFaces[n - 1]
+    void layout(
         const IFontFace* face,
-        const std::string& text,
+        std::string_view text,
         const TextStyle& textStyle,
         const ParagraphStyle& paragraphStyle,
         const Size& maxSize,
+        std::vector<GlyphPosition>& outGlyphs,
+        std::vector<std::shared_ptr<IFontFace>>& outFallbackFaces,
         Size& outContentSize
     );
+
+    // the content size layout would report, without placing glyphs
+    Size measure(
+        const IFontFace* face,
+        std::string_view text,
+        const TextStyle& textStyle,
+        const ParagraphStyle& paragraphStyle,
+        const Size& maxSize
+    );
+
+    static LineMetrics lineMetrics(
+        const IFontFace* face, const TextStyle& textStyle, const ParagraphStyle& paragraphStyle
+    );
+
+    ShapeCache& shapeCache();
+
+private:
+    struct LayoutFace;
+
+    // outGlyphs, outFallbackFaces: nullptr to only measure
+    Size layoutLines(
+        const IFontFace* face,
+        std::string_view text,
+        const TextStyle& textStyle,
+        const ParagraphStyle& paragraphStyle,
+        const Size& maxSize,
+        std::vector<GlyphPosition>* outGlyphs,
+        std::vector<std::shared_ptr<IFontFace>>* outFallbackFaces
+    );
+    // splits the line into runs of one face and script, and shapes each run with its face.
+    // the result is in the shaping scratch of the thread
+    void shapeItemizedLine(
+        std::string_view line,
+        const TextStyle& textStyle,
+        ParagraphStyle::Direction direction,
+        std::vector<LayoutFace>& faces,
+        bool useCache
+    );
+
+    // the result is valid until the next call on the same thread. simpleShaper: nullptr to always use HarfBuzz
+    const ShapedRun& shapeLine(
+        hb_font_t* hbFont,
+        std::string_view line,
+        ParagraphStyle::Direction direction,
+        const std::string& language,
+        const SimpleShaper* simpleShaper,
+        bool useCache
+    );
+
+    ShapeCache m_shapeCache;
+    FontLoader* m_fallbackLoader;
 };
 } // karin
 
@@ -0,0 +1,482 @@
+#include "fontconfig_font_index.h"
+
+#include <fontconfig/fontconfig.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+#include <utils/hash.h>
+
+namespace
+{
+using namespace karin;
+
+constexpr const char* INDEX_MAGIC = "karin-font-index";
+constexpr int INDEX_VERSION = 1;
+
+Font::Style toFontStyle(int slant)
+{
+    switch (slant)
+    {
+    case FC_SLANT_ITALIC:
+        return Font::Style::ITALIC;
+    case FC_SLANT_OBLIQUE:
+        return Font::Style::OBLIQUE;
+    default:
+        return Font::Style::NORMAL;
+    }
+}
+
+Font::Stretch toFontStretch(int width)
+{
+    if (width <= FC_WIDTH_ULTRACONDENSED)
+        return Font::Stretch::ULTRA_CONDENSED;
+    else if (width <= FC_WIDTH_EXTRACONDENSED)
+        return Font::Stretch::EXTRA_CONDENSED;
+    else if (width <= FC_WIDTH_CONDENSED)
+        return Font::Stretch::CONDENSED;
+    else if (width <= FC_WIDTH_SEMICONDENSED)
+        return Font::Stretch::SEMI_CONDENSED;
+    else if (width == FC_WIDTH_NORMAL)
+        return Font::Stretch::NORMAL;
+    else if (width <= FC_WIDTH_SEMIEXPANDED)
+        return Font::Stretch::SEMI_EXPANDED;
+    else if (width <= FC_WIDTH_EXPANDED)
+        return Font::Stretch::EXPANDED;
+    else if (width <= FC_WIDTH_EXTRAEXPANDED)
+        return Font::Stretch::EXTRA_EXPANDED;
+    else
+        return Font::Stretch::ULTRA_EXPANDED;
+}
+
+Font::Weight toFontWeight(int weight)
+{
+    if (weight <= FC_WEIGHT_THIN)
+        return Font::Weight::THIN;
+    else if (weight <= FC_WEIGHT_EXTRALIGHT)
+        return Font::Weight::EXTRA_LIGHT;
+    else if (weight <= FC_WEIGHT_LIGHT)
+        return Font::Weight::LIGHT;
+    else if (weight <= FC_WEIGHT_DEMILIGHT)
+        return Font::Weight::SEMI_LIGHT;
+    else if (weight <= FC_WEIGHT_REGULAR)
+        return Font::Weight::NORMAL;
+    else if (weight <= FC_WEIGHT_MEDIUM)
+        return Font::Weight::MEDIUM;
+    else if (weight <= FC_WEIGHT_DEMIBOLD)
+        return Font::Weight::SEMI_BOLD;
+    else if (weight <= FC_WEIGHT_BOLD)
+        return Font::Weight::BOLD;
+    else if (weight <= FC_WEIGHT_EXTRABOLD)
+        return Font::Weight::EXTRA_BOLD;
+    else if (weight <= FC_WEIGHT_BLACK)
+        return Font::Weight::BLACK;
+    else
+        return Font::Weight::EXTRA_BLACK;
+}
+
+int toFcSlant(Font::Style style)
+{
+    switch (style)
+    {
+    case Font::Style::ITALIC:
+        return FC_SLANT_ITALIC;
+    case Font::Style::OBLIQUE:
+        return FC_SLANT_OBLIQUE;
+    default:
+        return FC_SLANT_ROMAN;
+    }
+}
+
+int toFcWidth(Font::Stretch stretch)
+{
+    switch (stretch)
+    {
+    case Font::Stretch::ULTRA_CONDENSED:
+        return FC_WIDTH_ULTRACONDENSED;
+    case Font::Stretch::EXTRA_CONDENSED:
+        return FC_WIDTH_EXTRACONDENSED;
+    case Font::Stretch::CONDENSED:
+        return FC_WIDTH_CONDENSED;
+    case Font::Stretch::SEMI_CONDENSED:
+        return FC_WIDTH_SEMICONDENSED;
+    case Font::Stretch::SEMI_EXPANDED:
+        return FC_WIDTH_SEMIEXPANDED;
+    case Font::Stretch::EXPANDED:
+        return FC_WIDTH_EXPANDED;
+    case Font::Stretch::EXTRA_EXPANDED:
+        return FC_WIDTH_EXTRAEXPANDED;
+    case Font::Stretch::ULTRA_EXPANDED:
+        return FC_WIDTH_ULTRAEXPANDED;
+    default:
+        return FC_WIDTH_NORMAL;
+    }
+}
+
+// Font::Weight follows the OpenType scale
+int toFcWeight(Font::Weight weight)
+{
+    return FcWeightFromOpenType(static_cast<int>(weight));
+}
+
+void hashStrList(size_t& seed, FcStrList* list)
+{
+    if (!list)
+    {
+        return;
+    }
+
+    FcChar8* entry = nullptr;
+    while ((entry = FcStrListNext(list)))
+    {
+        std::string path(reinterpret_cast<char*>(entry));
+        hash_combine(seed, path);
+
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (!ec)
+        {
+            hash_combine(seed, time.time_since_epoch().count());
+        }
+    }
+    FcStrListDone(list);
+}
+
+// changes whenever fontconfig's configuration or any font directory changes
+size_t configStamp()
+{
+    size_t seed = 0;
+    hash_combine(seed, FcGetVersion());
+
+    FcConfig* config = FcConfigGetCurrent();
+    hashStrList(seed, FcConfigGetConfigFiles(config));
+    hashStrList(seed, FcConfigGetFontDirs(config));
+
+    return seed;
+}
+
+std::filesystem::path indexFilePath()
+{
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome)
+    {
+        return std::filesystem::path(cacheHome) / "karin" / "font_index";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home)
+    {
+        return std::filesystem::path(home) / ".cache" / "karin" / "font_index";
+    }
+    return {};
+}
+}
+
+namespace karin
+{
+FontConfigFontIndex::FontConfigFontIndex()
+{
+    std::filesystem::path path = indexFilePath();
+    size_t stamp = configStamp();
+
+    if (!path.empty() && load(path, stamp))
+    {
+        return;
+    }
+
+    build();
+
+    if (!path.empty())
+    {
+        save(path, stamp);
+    }
+}
+
+std::optional<FontFileLocation> FontConfigFontIndex::find(const Font& font) const
+{
+    if (auto it = m_locations.find(font.hash()); it != m_locations.end())
+    {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+std::optional<FontFileLocation> FontConfigFontIndex::match(const Font& font) const
+{
+    FcPattern* pat = FcPatternCreate();
+    FcPatternAddString(pat, FC_FAMILY, reinterpret_cast<const FcChar8*>(font.family.c_str()));
+    FcPatternAddInteger(pat, FC_SLANT, toFcSlant(font.style));
+    FcPatternAddInteger(pat, FC_WEIGHT, toFcWeight(font.weight));
+    FcPatternAddInteger(pat, FC_WIDTH, toFcWidth(font.stretch));
+    FcConfigSubstitute(nullptr, pat, FcMatchPattern);
+    FcDefaultSubstitute(pat);
+
+    FcResult result = FcResultNoMatch;
+    FcPattern* matched = FcFontMatch(nullptr, pat, &result);
+    FcPatternDestroy(pat);
+
+    if (!matched)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<FontFileLocation> location;
+
+    char* filePath = nullptr;
+    if (FcPatternGetString(matched, FC_FILE, 0, reinterpret_cast<FcChar8**>(&filePath)) == FcResultMatch)
+    {
+        int index = 0;
+        FcPatternGetInteger(matched, FC_INDEX, 0, &index);
+
+        location = FontFileLocation{
+            .filePath = filePath,
+            .faceIndex = static_cast<uint32_t>(index),
+        };
+    }
+
+    FcPatternDestroy(matched);
+
+    return location;
+}
+
+std::vector<FallbackFont> FontConfigFontIndex::fallbacks(const Font& font) const
+{
+    FcPattern* pat = FcPatternCreate();
+    FcPatternAddString(pat, FC_FAMILY, reinterpret_cast<const FcChar8*>(font.family.c_str()));
+    FcPatternAddInteger(pat, FC_SLANT, toFcSlant(font.style));
+    FcPatternAddInteger(pat, FC_WEIGHT, toFcWeight(font.weight));
+    FcPatternAddInteger(pat, FC_WIDTH, toFcWidth(font.stretch));
+    FcConfigSubstitute(nullptr, pat, FcMatchPattern);
+    FcDefaultSubstitute(pat);
+
+    FcResult result = FcResultNoMatch;
+    FcFontSet* fontSet = FcFontSort(nullptr, pat, FcTrue, nullptr, &result);
+    FcPatternDestroy(pat);
+
+    std::vector<FallbackFont> fallbacks;
+    if (!fontSet)
+    {
+        return fallbacks;
+    }
+
+    for (int i = 0; i < fontSet->nfont; ++i)
+    {
+        FcPattern* fontPattern = fontSet->fonts[i];
+
+        char* filePath = nullptr;
+        FcCharSet* charSet = nullptr;
+        if (FcPatternGetString(fontPattern, FC_FILE, 0, reinterpret_cast<FcChar8**>(&filePath)) != FcResultMatch
+            || FcPatternGetCharSet(fontPattern, FC_CHARSET, 0, &charSet) != FcResultMatch)
+        {
+            continue;
+        }
+
+        int index = 0;
+        FcPatternGetInteger(fontPattern, FC_INDEX, 0, &index);
+
+        // charset pages are the same 256 code point bitsets
+        auto coverage = std::make_shared<FontCoverage>();
+        FcChar32 map[FC_CHARSET_MAP_SIZE];
+        FcChar32 next;
+        for (FcChar32 base = FcCharSetFirstPage(charSet, map, &next); base != FC_CHARSET_DONE;
+             base = FcCharSetNextPage(charSet, map, &next))
+        {
+            FontCoverage::Block block;
+            std::copy_n(map, block.size(), block.begin());
+            coverage->addBlock(base / FontCoverage::BLOCK_SIZE, block);
+        }
+
+        fallbacks.push_back({
+            .location = {.filePath = filePath, .faceIndex = static_cast<uint32_t>(index)},
+            .coverage = std::move(coverage),
+        });
+    }
+
+    FcFontSetDestroy(fontSet);
+
+    return fallbacks;
+}
+
+const std::vector<Font>& FontConfigFontIndex::fonts() const
+{
+    return m_fonts;
+}
+
+void FontConfigFontIndex::build()
+{
+    FcPattern* pat = FcPatternCreate();
+    FcObjectSet* os = FcObjectSetBuild(
+        FC_FAMILY,
+        FC_SLANT,
+        FC_WEIGHT,
+        FC_WIDTH,
+        FC_FILE,
+        FC_INDEX,
+        nullptr
+    );
+    FcFontSet* fs = FcFontList(nullptr, pat, os);
+
+    for (int i = 0; fs && i < fs->nfont; ++i)
+    {
+        FcPattern* fontPat = fs->fonts[i];
+
+        char* family = nullptr;
+        if (FcPatternGetString(fontPat, FC_FAMILY, 0, reinterpret_cast<FcChar8**>(&family)) != FcResultMatch)
+        {
+            continue;
+        }
+
+        char* filePath = nullptr;
+        if (FcPatternGetString(fontPat, FC_FILE, 0, reinterpret_cast<FcChar8**>(&filePath)) != FcResultMatch)
+        {
+            continue;
+        }
+
+        int slant = FC_SLANT_ROMAN;
+        FcPatternGetInteger(fontPat, FC_SLANT, 0, &slant);
+
+        int weight = FC_WEIGHT_REGULAR;
+        FcPatternGetInteger(fontPat, FC_WEIGHT, 0, &weight);
+
+        int width = FC_WIDTH_NORMAL;
+        FcPatternGetInteger(fontPat, FC_WIDTH, 0, &width);
+
+        int index = 0;
+        FcPatternGetInteger(fontPat, FC_INDEX, 0, &index);
+
+        addEntry(
+            Font{
+                .family = family,
+                .style = toFontStyle(slant),
+                .stretch = toFontStretch(width),
+                .weight = toFontWeight(weight),
+            },
+            FontFileLocation{
+                .filePath = filePath,
+                .faceIndex = static_cast<uint32_t>(index),
+            }
+        );
+    }
+
+    if (fs)
+    {
+        FcFontSetDestroy(fs);
+    }
+    FcObjectSetDestroy(os);
+    FcPatternDestroy(pat);
+}
+
+/*
+ * text format, one font per line after the header:
+ * karin-font-index <version> <stamp>
+ * <style>\t<stretch>\t<weight>\t<face index>\t<family>\t<file path>
+ */
+bool FontConfigFontIndex::load(const std::filesystem::path& path, size_t stamp)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    std::string magic;
+    int version = 0;
+    size_t fileStamp = 0;
+    file >> magic >> version >> fileStamp;
+    if (!file || magic != INDEX_MAGIC || version != INDEX_VERSION || fileStamp != stamp)
+    {
+        return false;
+    }
+    file.ignore(1);
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        int style = 0;
+        int stretch = 0;
+        int weight = 0;
+        uint32_t faceIndex = 0;
+        std::string family;
+        std::string filePath;
+
+        bool valid = static_cast<bool>(fields >> style >> stretch >> weight >> faceIndex);
+        fields.ignore(1);
+        std::getline(fields, family, '\t');
+        std::getline(fields, filePath);
+        if (!valid || family.empty() || filePath.empty())
+        {
+            m_fonts.clear();
+            m_locations.clear();
+            return false;
+        }
+
+        addEntry(
+            Font{
+                .family = std::move(family),
+                .style = static_cast<Font::Style>(style),
+                .stretch = static_cast<Font::Stretch>(stretch),
+                .weight = static_cast<Font::Weight>(weight),
+            },
+            FontFileLocation{
+                .filePath = std::move(filePath),
+                .faceIndex = faceIndex,
+            }
+        );
+    }
+
+    return true;
+}
+
+void FontConfigFontIndex::save(const std::filesystem::path& path, size_t stamp) const
+{
+    // the index is only a cache. failing to write it is not an error
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if (ec)
+    {
+        return;
+    }
+
+    // write then rename so that a concurrent reader never sees a partial index
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file)
+        {
+            return;
+        }
+
+        file << INDEX_MAGIC << ' ' << INDEX_VERSION << ' ' << stamp << '\n';
+        for (const Font& font : m_fonts)
+        {
+            const FontFileLocation& location = m_locations.at(font.hash());
+            file << static_cast<int>(font.style) << '\t'
+                << static_cast<int>(font.stretch) << '\t'
+                << static_cast<int>(font.weight) << '\t'
+                << location.faceIndex << '\t'
+                << font.family << '\t'
+                << location.filePath << '\n';
+        }
+
+        if (!file)
+        {
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+}
+
+void FontConfigFontIndex::addEntry(const Font& font, FontFileLocation location)
+{
+    // the first file listed for a style wins, same as a linear scan would
+    if (m_locations.try_emplace(font.hash(), std::move(location)).second)
+    {
+        m_fonts.push_back(font);
+    }
+}
+} // karin
@@ -0,0 +1,45 @@
+#ifndef SRC_GRAPHICS_TEXT_UNIX_FONTCONFIG_FONT_INDEX_H
+#define SRC_GRAPHICS_TEXT_UNIX_FONTCONFIG_FONT_INDEX_H
+
+#include <text/font_loader_platform.h>
+#include <karin/graphics/font.h>
+
+#include <filesystem>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace karin
+{
+/*
+ * Hashed index of the installed fonts, Font::hash() -> file path/face index.
+ * Built once from FcFontList and persisted to $XDG_CACHE_HOME/karin/font_index.
+ * The persisted index is reused while fontconfig's config files and font directories
+ * keep their timestamps. Requires FcInit() to have been called.
+ */
+class FontConfigFontIndex
+{
+public:
+    FontConfigFontIndex();
+    ~FontConfigFontIndex() = default;
+
+    // exact family/style/stretch/weight lookup
+    std::optional<FontFileLocation> find(const Font& font) const;
+    // closest installed font by FcFontMatch. slow; callers should cache the result
+    std::optional<FontFileLocation> match(const Font& font) const;
+    // FcFontSort without the fonts that add no coverage. slow; callers should cache the result
+    std::vector<FallbackFont> fallbacks(const Font& font) const;
+    const std::vector<Font>& fonts() const;
+
+private:
+    void build();
+    bool load(const std::filesystem::path& path, size_t stamp);
+    void save(const std::filesystem::path& path, size_t stamp) const;
+    void addEntry(const Font& font, FontFileLocation location);
+
+    std::vector<Font> m_fonts;
+    std::unordered_map<size_t, FontFileLocation> m_locations;
+};
+} // karin
+
+#endif //SRC_GRAPHICS_TEXT_UNIX_FONTCONFIG_FONT_INDEX_H
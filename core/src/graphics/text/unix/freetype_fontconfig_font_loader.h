@@ -2,6 +2,8 @@
 #define SRC_GRAPHICS_TEXT_UNIX_FREETYPE_FONTCONFIG_FONT_LOADER_H
 
 #include <text/font_loader_platform.h>
+#include "fontconfig_font_index.h"
+
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
@@ -14,11 +16,14 @@ public:
     ~FreeTypeFontConfigFontLoader() override;
 
     std::unique_ptr<IFontFace> loadFont(const Font& font) override;
-    std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath) override;
+    std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath, uint32_t faceIndex = 0) override;
     std::vector<Font> getFontLists() override;
+    std::optional<FontFileLocation> findFontFile(const Font& font) override;
+    std::vector<FallbackFont> findFallbackFonts(const Font& font) override;
 
 private:
     FT_Library m_ftLibrary = nullptr;
+    std::unique_ptr<FontConfigFontIndex> m_fontIndex;
 };
 } // karin
 
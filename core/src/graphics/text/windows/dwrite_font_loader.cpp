@@ -67,7 +67,7 @@ std::unique_ptr<IFontFace> DwriteFontLoader::loadFont(const Font& font)
     return std::make_unique<DwriteFontFace>(face);
 }
 
-std::unique_ptr<IFontFace> DwriteFontLoader::loadFontFromFile(const std::string& filePath)
+std::unique_ptr<IFontFace> DwriteFontLoader::loadFontFromFile(const std::string& filePath, uint32_t faceIndex)
 {
     Microsoft::WRL::ComPtr<IDWriteFontFile> fontFile;
     HRESULT hr = D2DContext::instance().dwriteFactory()->CreateFontFileReference(
@@ -97,7 +97,7 @@ std::unique_ptr<IFontFace> DwriteFontLoader::loadFontFromFile(const std::string&
         faceType,
         1,
         fontFile.GetAddressOf(),
-        0,
+        faceIndex,
         DWRITE_FONT_SIMULATIONS_NONE,
         &fontFace
     );
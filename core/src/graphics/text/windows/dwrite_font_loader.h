@@ -16,7 +16,7 @@ public:
     ~DwriteFontLoader() override;
 
     std::unique_ptr<IFontFace> loadFont(const Font& font) override;
-    std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath) override;
+    std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath, uint32_t faceIndex = 0) override;
     std::vector<Font> getFontLists() override;
 };
 } // karin
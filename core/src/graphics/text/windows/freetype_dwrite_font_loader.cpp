@@ -148,7 +148,7 @@ std::unique_ptr<IFontFace> FreeTypeDWriteFontLoader::loadFont(const Font& font)
         m_library,
         reinterpret_cast<const FT_Byte*>(m_fontDataStorage.back().data()),
         static_cast<FT_Long>(m_fontDataStorage.back().size()),
-        0,
+        static_cast<FT_Long>(fontFace->GetIndex()),
         &face
     );
     if (err)
@@ -160,10 +160,10 @@ std::unique_ptr<IFontFace> FreeTypeDWriteFontLoader::loadFont(const Font& font)
     return std::make_unique<FreetypeFontFace>(face);
 }
 
-std::unique_ptr<IFontFace> FreeTypeDWriteFontLoader::loadFontFromFile(const std::string& filePath)
+std::unique_ptr<IFontFace> FreeTypeDWriteFontLoader::loadFontFromFile(const std::string& filePath, uint32_t faceIndex)
 {
     FT_Face face = nullptr;
-    FT_Error err = FT_New_Face(m_library, filePath.c_str(), 0, &face);
+    FT_Error err = FT_New_Face(m_library, filePath.c_str(), static_cast<FT_Long>(faceIndex), &face);
     if (err)
     {
         std::cerr << "failed to load font from file: " << filePath << std::endl;
@@ -19,7 +19,7 @@ public:
     ~FreeTypeDWriteFontLoader() override;
 
     std::unique_ptr<IFontFace> loadFont(const Font& font) override;
-    std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath) override;
+    std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath, uint32_t faceIndex = 0) override;
     std::vector<Font> getFontLists() override;
 
 private:
@@ -0,0 +1,25 @@
+#ifndef SRC_GRAPHICS_VULKAN_CORNER_JOIN_H
+#define SRC_GRAPHICS_VULKAN_CORNER_JOIN_H
+
+#include <karin/graphics/stroke_style.h>
+
+#include <numbers>
+
+namespace karin
+{
+/*
+ * Join of the right angle corners of a rectangle stroke, the same as the tessellator joins polylines.
+ * A right angle miter is sqrt(2) stroke widths long, so it is beveled under a smaller miter limit.
+ */
+inline StrokeStyle::JoinStyle rightAngleJoinStyle(const StrokeStyle& strokeStyle)
+{
+    if (strokeStyle.join_style == StrokeStyle::JoinStyle::Miter
+        && strokeStyle.miter_limit < std::numbers::sqrt2_v<float>)
+    {
+        return StrokeStyle::JoinStyle::Bevel;
+    }
+    return strokeStyle.join_style;
+}
+} // karin
+
+#endif //SRC_GRAPHICS_VULKAN_CORNER_JOIN_H
@@ -0,0 +1,20 @@
+#ifndef SRC_GRAPHICS_VULKAN_GLYPH_QUAD_H
+#define SRC_GRAPHICS_VULKAN_GLYPH_QUAD_H
+
+#include <karin/common/geometry/point.h>
+
+namespace karin
+{
+/*
+ * Top-left corner of an atlas glyph bitmap in text space, y down.
+ * position: GlyphPosition::position, which is the pen position plus the left bearing. Bitmaps are placed
+ * from the pen position, so the bearing is taken off again.
+ * left, top, bearingX: pixels at the raster size, y up. scale: drawn size / raster size
+ */
+inline Point glyphQuadOrigin(Point position, float left, float top, float bearingX, float scale)
+{
+    return {position.x + (left - bearingX) * scale, position.y - top * scale};
+}
+} // karin
+
+#endif //SRC_GRAPHICS_VULKAN_GLYPH_QUAD_H
@@ -1,14 +1,133 @@
+const float PI = 3.14159265;
+
+// signed distance from p to [start, end] on a line. negative: inside
+float intervalDistance(float p, float start, float end) {
+    return max(start - p, p - end);
+}
+
+// uv: (offset from the center line, arc length) in pixels
+float signedDistanceFromStroke(vec2 uv) {
+    float halfWidth = push.strokeWidth * 0.5;
+    float across = abs(uv.x);
+
+    float period = dot(push.dashPattern[0] + push.dashPattern[1], vec4(1.0));
+    if (period <= 0.0) { // solid
+        return across - halfWidth;
+    }
+
+    // even entries are dashes, odd entries gaps. the first dash of the next period starts at period
+    float p = mod(uv.y + push.dashOffset, period);
+    float along = intervalDistance(p, period, period + push.dashPattern[0].x);
+    float dashStart = 0.0;
+    for (int i = 0; i < 8; i += 2) {
+        float dash = push.dashPattern[i / 4][i % 4];
+        along = min(along, intervalDistance(p, dashStart, dashStart + dash));
+        dashStart += dash + push.dashPattern[i / 4][i % 4 + 1];
+    }
+
+    uint dashCapStyle = push.dashCapStyle;
+
+    if (dashCapStyle == 1) { // Round
+        return length(vec2(max(along, 0.0), across)) - halfWidth;
+    } else if (dashCapStyle == 2) { // Square
+        return max(along - halfWidth, across - halfWidth);
+    } else if (dashCapStyle == 3) { // Triangle
+        return max(along, 0.0) + across - halfWidth;
+    }
+    return max(along, across - halfWidth); // Butt
+}
+
+// approximate distance to the outline of an ellipse centered at the origin
+float ellipseDistance(vec2 p, vec2 radius) {
+    float k1 = length(p / radius);
+    float k0 = length(p / (radius * radius));
+    return k0 > 0.0 ? k1 * (k1 - 1.0) / k0 : -min(radius.x, radius.y);
+}
+
+// Ramanujan's approximation
+float quarterEllipseLength(vec2 radius) {
+    float a = radius.x;
+    float b = radius.y;
+    return 0.25 * PI * (3.0 * (a + b) - sqrt((3.0 * a + b) * (a + 3.0 * b)));
+}
+
+// p: in the top right quadrant (x >= 0, y <= 0. y-axis is down)
+// joinStyle: StrokeStyle::JoinStyle of a corner without radius
+// return: (signed distance to the outline, clockwise arc length from the top center)
+vec2 roundedRectQuadrantOutline(vec2 p, vec2 halfSize, vec2 radius, uint joinStyle) {
+    vec2 cornerCenter = vec2(halfSize.x - radius.x, radius.y - halfSize.y);
+    vec2 cornerPos = vec2(p.x - cornerCenter.x, cornerCenter.y - p.y);
+    float cornerLength = quarterEllipseLength(radius);
+
+    if (cornerPos.x > 0.0 && cornerPos.y > 0.0) {
+        if (min(radius.x, radius.y) <= 0.0) { // sharp corner. the stroke edge is a square, a chamfer or an arc
+            float cornerDistance;
+            if (joinStyle == 0) { // Miter
+                cornerDistance = max(cornerPos.x, cornerPos.y);
+            } else if (joinStyle == 2) { // Bevel
+                cornerDistance = cornerPos.x + cornerPos.y;
+            } else { // Round
+                cornerDistance = length(cornerPos);
+            }
+            return vec2(cornerDistance, cornerCenter.x);
+        }
+
+        float angle = atan(cornerPos.x / radius.x, cornerPos.y / radius.y);
+        return vec2(ellipseDistance(cornerPos, radius), cornerCenter.x + cornerLength * angle / (0.5 * PI));
+    }
+
+    float topDistance = -halfSize.y - p.y;
+    float rightDistance = p.x - halfSize.x;
+    if (topDistance > rightDistance) {
+        return vec2(topDistance, p.x);
+    }
+    return vec2(rightDistance, cornerCenter.x + cornerLength + p.y - cornerCenter.y);
+}
+
+// p: relative to the center in pixels
+// return: (signed distance to the outline, clockwise arc length from the top center)
+vec2 roundedRectOutline(vec2 p, vec2 halfSize, vec2 radius, uint joinStyle) {
+    // rotate p onto the top right quadrant. quadrants are visited clockwise and have the same length
+    float quadrant;
+    if (p.x >= 0.0 && p.y < 0.0) {
+        quadrant = 0.0;
+    } else if (p.x >= 0.0) {
+        quadrant = 1.0;
+        p = vec2(p.y, -p.x);
+    } else if (p.y >= 0.0) {
+        quadrant = 2.0;
+        p = -p;
+    } else {
+        quadrant = 3.0;
+        p = vec2(-p.y, p.x);
+    }
+
+    vec2 outline = mod(quadrant, 2.0) == 0.0
+        ? roundedRectQuadrantOutline(p, halfSize, radius, joinStyle)
+        : roundedRectQuadrantOutline(p, halfSize.yx, radius.yx, joinStyle);
+
+    float quadrantLength = halfSize.x - radius.x + halfSize.y - radius.y + quarterEllipseLength(radius);
+    return vec2(outline.x, quadrant * quadrantLength + outline.y);
+}
+
 // positive: outside, negative: inside
+// any scale works: coverage divides by the screen-space derivative
 float signedDistanceFromUv(vec2 uv, uint shapeType, vec2 shapeParams) {
     float signedDistance;
 
     if (shapeType == 1) { // Ellipse(normalized -> circle)
         signedDistance = length(uv) - 1.0;
     } else if (shapeType == 2) { // Rounded Rectangle
-        vec2 cornerPos = abs(uv) - vec2(1.0, 1.0) + shapeParams;
+        vec2 radius = max(shapeParams, vec2(0.0001));
+        vec2 cornerPos = abs(uv) - vec2(1.0, 1.0) + radius;
         signedDistance = min(cornerPos.x, cornerPos.y) < 0.0
-        ? -1.0
-        : length(cornerPos / shapeParams) - 1.0;
+        ? max(cornerPos.x / radius.x, cornerPos.y / radius.y) - 1.0
+        : length(cornerPos / radius) - 1.0;
+    } else if (shapeType == 3) { // Stroke
+        signedDistance = signedDistanceFromStroke(uv);
+    } else if (shapeType == 5) { // Rectangle
+        vec2 edgePos = abs(uv) - vec2(1.0, 1.0);
+        signedDistance = max(edgePos.x, edgePos.y);
     } else {
         signedDistance = -1.0;
     }
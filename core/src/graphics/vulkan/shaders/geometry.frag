@@ -6,6 +6,7 @@
 layout(location = 0) out vec4 outColor;
 layout(location = 0) in vec2 uv;
 layout(location = 1) in vec2 pixelPos;
+layout(location = 2) in vec2 localPos;
 
 // image: image, gradient: gradientLut
 layout(set = 1, binding = 0) uniform sampler2D tex;
@@ -13,9 +14,23 @@ layout(set = 1, binding = 0) uniform sampler2D tex;
 #include "common.glsl"
 
 void main() {
-    float signedDistance = signedDistanceFromUv(uv, push.shapeType, push.shapeParams);
+    float coverage;
+    if (push.shapeType == 6) { // Feathered
+        coverage = clamp(uv.x, 0.0, 1.0);
+    } else {
+        float signedDistance;
+        if (push.shapeType == 4) { // Rounded Rectangle Stroke
+            vec2 outline = roundedRectOutline(localPos, uv, push.shapeParams, push.joinStyle);
+            signedDistance = signedDistanceFromStroke(outline);
+        } else {
+            signedDistance = signedDistanceFromUv(uv, push.shapeType, push.shapeParams);
+        }
 
-    if (signedDistance > 0.0) {
+        // one pixel wide ramp centered on the edge. no MSAA needed
+        coverage = clamp(0.5 - signedDistance / max(fwidth(signedDistance), 0.0001), 0.0, 1.0);
+    }
+
+    if (coverage <= 0.0) {
         discard;
     }
 
@@ -36,4 +51,6 @@ void main() {
     } else {
         discard;
     }
+
+    outColor.a *= coverage;
 }
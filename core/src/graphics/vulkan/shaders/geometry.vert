@@ -7,13 +7,15 @@ layout(location = 0) in vec2 pos;
 layout(location = 1) in vec2 inUv;
 layout(location = 0) out vec2 uv;
 layout(location = 1) out vec2 pixelPos;
+layout(location = 2) out vec2 localPos;
 
 layout(set = 0, binding = 0) uniform Matrices {
     mat4 projection;
 } matrices;
 
 void main() {
-    gl_Position = matrices.projection * push.model * vec4(pos, 0.0, 1.0);
+    pixelPos = push.model * vec3(pos, 1.0);
+    gl_Position = matrices.projection * vec4(pixelPos, 0.0, 1.0);
     uv = inUv;
-    pixelPos = (push.model * vec4(pos, 0.0, 1.0)).xy;
+    localPos = pos;
 }
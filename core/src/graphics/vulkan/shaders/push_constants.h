@@ -5,6 +5,9 @@
 #include <glm/glm.hpp>
 #include <karin/graphics/pattern.h>
 
+#include <array>
+#include <cstddef>
+
 namespace karin
 {
 enum class ShapeType : uint32_t
@@ -12,9 +15,22 @@ enum class ShapeType : uint32_t
     Nothing = 0,
     Ellipse = 1,
     RoundedRectangle = 2,
+    // tessellated stroke. uv: (offset from the center line, arc length) in pixels
+    Stroke = 3,
+    // one quad around the outline. ellipse: radius = half size, rectangle: radius = 0
+    RoundedRectangleStroke = 4,
+    Rectangle = 5,
+    // tessellated fill with a feathered outline. uv.x: coverage
+    Feathered = 6,
+    // text whose glyph atlas entries are signed distance fields
+    DistanceField = 7,
 };
 
-struct FragPushConstants
+// dash and gap lengths the stroke shader evaluates
+constexpr size_t MAX_DASH_PATTERN_LENGTH = 8;
+
+// same offsets as the std430 block below: vec4s are 16-byte aligned and the block ends on a vec4 boundary
+struct alignas(16) FragPushConstants
 {
     // color(vec4) in solid color
     // start(vec2) + end(vec2) in linear gradient
@@ -22,7 +38,8 @@ struct FragPushConstants
     // offset(vec2) + scale(vec2) in image
     glm::vec4 color;
 
-    // only used in rounded rectangle. vec2: normalized radius (radiusX / (width / 2), radiusY / (height / 2))
+    // rounded rectangle. vec2: normalized radius (radiusX / (width / 2), radiusY / (height / 2))
+    // rounded rectangle stroke. vec2: radius in pixels (uv: half size in pixels)
     glm::vec2 shapeParams;
     uint32_t shapeType = static_cast<uint32_t>(ShapeType::Nothing);
     uint32_t patternType = static_cast<uint32_t>(PatternType::SolidColor);
@@ -30,12 +47,36 @@ struct FragPushConstants
     // radiusX(float) + radiusY(float) in radial gradient
     // imageSize(vec2), uvMode(float) in image (0 = uv(image), 1 = window coordinates(image pattern))
     glm::vec4 patternParams;
+
+    // only used in strokes. lengths in pixels, like StrokeStyle on this backend
+    // dash, gap, dash, ... up to MAX_DASH_PATTERN_LENGTH lengths, zero after the pattern. all zero: solid
+    std::array<glm::vec4, MAX_DASH_PATTERN_LENGTH / 4> dashPattern{};
+    float strokeWidth = 0.0f;
+    float dashOffset = 0.0f;
+    // StrokeStyle::CapStyle
+    uint32_t dashCapStyle = 0;
+    // StrokeStyle::JoinStyle of rounded rectangle stroke corners without radius. Miter: within the miter limit
+    uint32_t joinStyle = 0;
+
+    bool operator==(const FragPushConstants&) const = default;
 };
 
 struct VertexPushConstants
 {
-    glm::mat4 model;
+    // 2D affine transform. columns: x axis, y axis, translation
+    glm::mat3x2 model;
 };
+
+// drops the z row and column of a 2D transform
+inline glm::mat3x2 toAffine2D(const glm::mat4& m)
+{
+    return glm::mat3x2(glm::vec2(m[0]), glm::vec2(m[1]), glm::vec2(m[3]));
+}
+
+static_assert(offsetof(FragPushConstants, dashPattern) == 48 && offsetof(FragPushConstants, strokeWidth) == 80);
+static_assert(sizeof(FragPushConstants) == 96, "VertexPushConstants starts at offset 96 in geometry.vert");
+// 128 bytes is the smallest maxPushConstantsSize a device may report
+static_assert(sizeof(FragPushConstants) + sizeof(VertexPushConstants) <= 128);
 }
 
 #else // glsl
@@ -49,13 +90,18 @@ layout (push_constant) uniform PushConstants
     uint shapeType;
     uint patternType;
     vec4 patternParams;
+    vec4 dashPattern[2];
+    float strokeWidth;
+    float dashOffset;
+    uint dashCapStyle;
+    uint joinStyle;
 } push;
 
 #elif defined(VERTEX_SHADER)
 
 layout (push_constant) uniform TransformMatrix
 {
-    layout(offset = 48) mat4 model;
+    layout(offset = 96) mat3x2 model;
 } push;
 
 #endif
@@ -6,22 +6,31 @@
 layout(location = 0) out vec4 outColor;
 layout(location = 0) in vec2 uv;
 layout(location = 1) in vec2 pixelPos;
+layout(location = 3) flat in uint page;
+// solid color pattern
+layout(location = 4) flat in vec4 color;
 
 // image: image, gradient: gradientLut
 layout(set = 1, binding = 0) uniform sampler2D tex;
-layout(set = 2, binding = 0) uniform sampler2D glyphAtlas;
+// one layer per atlas page
+layout(set = 2, binding = 0) uniform sampler2DArray glyphAtlas;
 
 #include "common.glsl"
 
 void main() {
-    float glyphAlpha = texture(glyphAtlas, uv).r;
+    float glyphAlpha = texture(glyphAtlas, vec3(uv, float(page))).r;
+    if (push.shapeType == 7) { // distance field. 0.5 is the outline
+        // antialias over one screen pixel whatever the scale or rotation
+        float distanceWidth = max(fwidth(glyphAlpha), 1e-4);
+        glyphAlpha = clamp((glyphAlpha - 0.5) / distanceWidth + 0.5, 0.0, 1.0);
+    }
 
     if (glyphAlpha < 0.01) {
         discard;
     }
 
     if (push.patternType == 0) { // solid
-        outColor = push.color;
+        outColor = color;
     } else if (push.patternType == 1) { // linear gradient
         float t = linear_gradient_t();
         outColor = texture(tex, vec2(t, 0.5));
@@ -0,0 +1,35 @@
+#version 450
+
+// one instance per glyph, already in window coordinates
+layout(location = 0) in vec2 glyphPos;
+layout(location = 1) in vec2 glyphAxisX;
+layout(location = 2) in vec2 glyphAxisY;
+layout(location = 3) in vec4 glyphUv;
+layout(location = 4) in uint glyphPage;
+layout(location = 5) in vec4 glyphColor;
+
+layout(location = 0) out vec2 uv;
+layout(location = 1) out vec2 pixelPos;
+layout(location = 3) flat out uint page;
+layout(location = 4) flat out vec4 color;
+
+layout(set = 0, binding = 0) uniform Matrices {
+    mat4 projection;
+} matrices;
+
+// two triangles of the unit quad. drawn with 6 vertices per instance
+const vec2 QUAD_CORNERS[6] = vec2[](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+    vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0)
+);
+
+void main() {
+    vec2 corner = QUAD_CORNERS[gl_VertexIndex];
+    vec2 pos = glyphPos + corner.x * glyphAxisX + corner.y * glyphAxisY;
+
+    gl_Position = matrices.projection * vec4(pos, 0.0, 1.0);
+    uv = glyphUv.xy + corner * glyphUv.zw;
+    pixelPos = pos;
+    page = glyphPage;
+    color = glyphColor;
+}
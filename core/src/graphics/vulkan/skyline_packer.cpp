@@ -0,0 +1,131 @@
+#include "skyline_packer.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace karin
+{
+SkylinePacker::SkylinePacker(int width, int height)
+    : m_width(width), m_height(height)
+{
+    reset();
+}
+
+std::optional<SkylinePacker::Position> SkylinePacker::pack(int width, int height)
+{
+    if (width <= 0 || height <= 0 || width > m_width || height > m_height)
+    {
+        return std::nullopt;
+    }
+
+    size_t bestIndex = 0;
+    int bestY = std::numeric_limits<int>::max();
+    int bestWidth = std::numeric_limits<int>::max();
+    for (size_t i = 0; i < m_skyline.size(); ++i)
+    {
+        std::optional<int> y = fitAt(i, width, height);
+        if (!y)
+        {
+            continue;
+        }
+
+        // lowest position first, then the narrowest segment to keep gaps small
+        if (*y < bestY || (*y == bestY && m_skyline[i].width < bestWidth))
+        {
+            bestIndex = i;
+            bestY = *y;
+            bestWidth = m_skyline[i].width;
+        }
+    }
+
+    if (bestY == std::numeric_limits<int>::max())
+    {
+        return std::nullopt;
+    }
+
+    Position position{m_skyline[bestIndex].x, bestY};
+    addSkylineLevel(bestIndex, position, width, height);
+    return position;
+}
+
+void SkylinePacker::reset()
+{
+    m_skyline.clear();
+    m_skyline.push_back(Segment{0, 0, m_width});
+}
+
+int SkylinePacker::width() const
+{
+    return m_width;
+}
+
+int SkylinePacker::height() const
+{
+    return m_height;
+}
+
+std::optional<int> SkylinePacker::fitAt(size_t index, int width, int height) const
+{
+    int x = m_skyline[index].x;
+    if (x + width > m_width)
+    {
+        return std::nullopt;
+    }
+
+    int y = 0;
+    int remaining = width;
+    for (size_t i = index; remaining > 0; ++i)
+    {
+        y = std::max(y, m_skyline[i].y);
+        if (y + height > m_height)
+        {
+            return std::nullopt;
+        }
+        remaining -= m_skyline[i].width;
+    }
+
+    return y;
+}
+
+void SkylinePacker::addSkylineLevel(size_t index, Position position, int width, int height)
+{
+    m_skyline.insert(
+        m_skyline.begin() + static_cast<std::ptrdiff_t>(index),
+        Segment{position.x, position.y + height, width}
+    );
+
+    // shrink or remove the segments now covered by the new one
+    int right = position.x + width;
+    for (size_t i = index + 1; i < m_skyline.size();)
+    {
+        Segment& segment = m_skyline[i];
+        if (segment.x >= right)
+        {
+            break;
+        }
+
+        int overlap = right - segment.x;
+        if (overlap < segment.width)
+        {
+            segment.x += overlap;
+            segment.width -= overlap;
+            break;
+        }
+        m_skyline.erase(m_skyline.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    // merge neighbours at the same height
+    for (size_t i = 0; i + 1 < m_skyline.size();)
+    {
+        if (m_skyline[i].y == m_skyline[i + 1].y)
+        {
+            m_skyline[i].width += m_skyline[i + 1].width;
+            m_skyline.erase(m_skyline.begin() + static_cast<std::ptrdiff_t>(i + 1));
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+} // karin
@@ -0,0 +1,51 @@
+#ifndef SRC_GRAPHICS_VULKAN_SKYLINE_PACKER_H
+#define SRC_GRAPHICS_VULKAN_SKYLINE_PACKER_H
+
+#include <optional>
+#include <vector>
+
+namespace karin
+{
+/*
+ * Bottom-left skyline rectangle packer.
+ * The skyline is the top edge of the packed area, stored as segments sorted by x.
+ * Rectangles cannot be freed individually; reset() clears the whole area.
+ */
+class SkylinePacker
+{
+public:
+    struct Position
+    {
+        int x;
+        int y;
+    };
+
+    SkylinePacker(int width, int height);
+    ~SkylinePacker() = default;
+
+    // nullopt if the rectangle does not fit anywhere
+    std::optional<Position> pack(int width, int height);
+    void reset();
+
+    int width() const;
+    int height() const;
+
+private:
+    struct Segment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    // lowest y at which a rectangle of the given width can sit with its left edge on segment index
+    std::optional<int> fitAt(size_t index, int width, int height) const;
+    void addSkylineLevel(size_t index, Position position, int width, int height);
+
+    int m_width;
+    int m_height;
+    std::vector<Segment> m_skyline;
+};
+} // karin
+
+#endif //SRC_GRAPHICS_VULKAN_SKYLINE_PACKER_H
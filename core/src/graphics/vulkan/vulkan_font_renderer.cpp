@@ -1,13 +1,21 @@
 #include "vulkan_font_renderer.h"
 
+#include <algorithm>
+#include <array>
+#include <span>
+#include <cmath>
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "glyph_quad.h"
 #include "text/freetype/freetype_font_face.h"
 #include "vulkan_pipeline.h"
 #include "vulkan_renderer_impl.h"
+#include "vulkan_tessellator.h"
+
+#include <utils/hash.h>
 
 namespace
 {
@@ -58,15 +66,33 @@ FragPushConstants createFragPushConstantData(const Pattern& pattern)
     );
 }
 
-VertexPushConstants createVertexPushConstantData(const Transform2D& transform, const Point& position)
+uint16_t toUnorm16(float value)
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+uint8_t toUnorm8(float value)
+{
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+std::array<uint8_t, 4> instanceColor(const Pattern& pattern)
+{
+    if (const auto* solid = std::get_if<SolidColorPattern>(&pattern))
+    {
+        Color color = solid->color();
+        return {toUnorm8(color.r), toUnorm8(color.g), toUnorm8(color.b), toUnorm8(color.a)};
+    }
+    return {};
+}
+
+glm::mat4 textModelMatrix(const Transform2D& transform, const Point& position)
 {
     glm::mat4 translateMatrix = glm::translate(
         glm::mat4(1.0f),
         glm::vec3(position.x, position.y, 0.0f)
     );
-    return VertexPushConstants{
-        .model = translateMatrix * glm::make_mat4(transform.colMajorData())
-    };
+    return translateMatrix * glm::make_mat4(transform.colMajorData());
 }
 }
 
@@ -89,93 +115,418 @@ void VulkanFontRenderer::drawText(
     const Transform2D& transform
 ) const
 {
-    auto* ftFontFace = dynamic_cast<FreetypeFontFace*>(text.fontFace.get());
-    if (!ftFontFace)
+    if (!text.fontFace)
     {
-        std::cerr << "Unsupported font face type in VulkanFontRenderer::drawText" << std::endl;
         return;
     }
 
-    FontMetrics fontMetrics = ftFontFace->getFontMetrics();
-    float scale = text.fontEmSize / fontMetrics.unitsPerEm;
+    VulkanGlyphCache::GlyphFormat format = m_renderMode == TextRenderMode::DistanceField
+        ? VulkanGlyphCache::GlyphFormat::DistanceField
+        : VulkanGlyphCache::GlyphFormat::Coverage;
 
-    std::vector<GlyphUploadPosition> glyphsToUpload;
-    glyphsToUpload.reserve(text.glyphs.size());
-    for (const auto& glyphPos : text.glyphs)
+    if (findGlyphs(text, format) && m_pendingTexts.empty())
     {
-        VulkanGlyphCache::GlyphInfo glyphInfo = m_glyphCache->getGlyph(glyphPos.glyphIndex, text.font.hash(), ftFontFace->face(), text.fontEmSize);
-        GlyphMetrics metrics = ftFontFace->getGlyphMetrics(glyphPos.glyphIndex);
-
-        glyphsToUpload.push_back({
-            .position = Rectangle(
-                glyphPos.position.x,
-                glyphPos.position.y - metrics.bearingY * scale,
-                metrics.width * scale,
-                metrics.height * scale
-            ),
-            .atlasUV = glyphInfo.uv
-        });
+        addTextInstances(text, start, pattern, transform, format);
+        return;
     }
-    
-    std::vector<VulkanPipeline::Vertex> vertices;
-    std::vector<uint16_t> indices;
 
-    for (const auto& glyph : glyphsToUpload)
+    for (size_t i = 0; i < text.glyphs.size(); ++i)
     {
-        Rectangle pos = Rectangle(
-            -text.layoutSize.width / 2.0f + glyph.position.pos.x,
-            -text.layoutSize.height / 2.0f + glyph.position.pos.y,
-            glyph.position.size.width,
-            glyph.position.size.height
+        if (m_glyphInfos[i])
+        {
+            continue;
+        }
+
+        // only rasterizing needs the FreeType face
+        const std::shared_ptr<IFontFace>& fontFace = text.faceOf(text.glyphs[i]);
+        auto* ftFontFace = dynamic_cast<FreetypeFontFace*>(fontFace.get());
+        if (!ftFontFace)
+        {
+            std::cerr << "Unsupported font face type in VulkanFontRenderer::drawText" << std::endl;
+            return;
+        }
+        m_glyphCache->requestGlyph(
+            text.glyphs[i].glyphIndex, fontFace->id(), text.fontEmSize, format, ftFontFace->face(), fontFace
         );
+    }
 
-        size_t baseIndex = vertices.size();
+    // drawn once the frame's missing glyphs are rasterized. later texts wait too, to keep the draw order
+    m_pendingTexts.emplace_back(PendingText{text, start, pattern, transform, format});
+}
 
-        vertices.push_back(
+void VulkanFontRenderer::flushGlyphUploads(VkCommandBuffer commandBuffer, size_t frameIndex)
+{
+    if (!m_pendingTexts.empty())
+    {
+        m_glyphCache->rasterizeRequestedGlyphs();
+        for (const auto& pendingEntry : m_pendingTexts)
+        {
+            if (const auto* pending = std::get_if<PendingText>(&pendingEntry))
             {
-                .pos = {pos.pos.x, pos.pos.y},
-                .uv = {glyph.atlasUV.pos.x, glyph.atlasUV.pos.y}
+                findGlyphs(pending->text, pending->format);
+                addTextInstances(pending->text, pending->start, pending->pattern, pending->transform, pending->format);
             }
-        );
-        vertices.push_back(
+            else if (const auto* pending = std::get_if<PendingGrid>(&pendingEntry))
             {
-                .pos = {pos.pos.x + pos.size.width, pos.pos.y},
-                .uv = {glyph.atlasUV.pos.x + glyph.atlasUV.size.width, glyph.atlasUV.pos.y}
+                GridCache& cache = m_gridCaches[pending->grid.id()];
+                updateGridRows(pending->grid, pending->format, cache);
+                addGridInstances(pending->grid, pending->start, pending->format, cache);
             }
-        );
-        vertices.push_back(
+        }
+        m_pendingTexts.clear();
+    }
+
+    std::erase_if(m_gridCaches, [this](const auto& entry) { return entry.second.lastUsedFrame != m_frame; });
+    if (m_outlines.size() > MAX_CACHED_OUTLINES)
+    {
+        std::erase_if(m_outlines, [this](const auto& entry) { return entry.second.lastUsedFrame != m_frame; });
+    }
+    ++m_frame;
+
+    m_glyphCache->flushUploadQueue(commandBuffer, frameIndex);
+    m_glyphCache->advanceFrame();
+}
+
+bool VulkanFontRenderer::findGlyphs(const TextBlob& text, VulkanGlyphCache::GlyphFormat format) const
+{
+    bool useOutlines = text.fontEmSize >= OUTLINE_GLYPH_SIZE;
+    bool found = true;
+    m_glyphInfos.resize(text.glyphs.size());
+    m_glyphMeshes.assign(text.glyphs.size(), nullptr);
+    for (size_t i = 0; i < text.glyphs.size(); ++i)
+    {
+        if (useOutlines)
+        {
+            m_glyphMeshes[i] = findOutline(text, text.glyphs[i]);
+            if (m_glyphMeshes[i])
             {
-                .pos = {pos.pos.x + pos.size.width, pos.pos.y + pos.size.height},
-                .uv = {
-                    glyph.atlasUV.pos.x + glyph.atlasUV.size.width,
-                    glyph.atlasUV.pos.y + glyph.atlasUV.size.height
-                }
+                // nothing to draw from the atlas
+                m_glyphInfos[i] = VulkanGlyphCache::GlyphInfo{};
+                continue;
             }
+        }
+
+        m_glyphInfos[i] = m_glyphCache->findGlyph(
+            text.glyphs[i].glyphIndex, text.faceOf(text.glyphs[i])->id(), text.fontEmSize, format
         );
-        vertices.push_back(
+        found = found && m_glyphInfos[i];
+    }
+    return found;
+}
+
+const GlyphOutline::Mesh* VulkanFontRenderer::findOutline(const TextBlob& text, const GlyphPosition& glyph) const
+{
+    const std::shared_ptr<IFontFace>& fontFace = text.faceOf(glyph);
+    OutlineKey key{.glyphIndex = glyph.glyphIndex, .faceId = fontFace->id()};
+    auto it = m_outlines.find(key);
+    if (it == m_outlines.end())
+    {
+        OutlineEntry entry;
+        if (auto* ftFontFace = dynamic_cast<FreetypeFontFace*>(fontFace.get()))
+        {
+            if (std::optional<GlyphOutline> outline = ftFontFace->loadGlyphOutline(glyph.glyphIndex))
             {
-                .pos = {pos.pos.x, pos.pos.y + pos.size.height},
-                .uv = {glyph.atlasUV.pos.x, glyph.atlasUV.pos.y + glyph.atlasUV.size.height}
+                entry.mesh = outline->tessellate();
+                if (entry.mesh->vertices.size() > MAX_OUTLINE_VERTICES)
+                {
+                    std::cerr << "glyph " << glyph.glyphIndex << " has too many outline vertices ("
+                        << entry.mesh->vertices.size() << "). drawing it from the atlas" << std::endl;
+                    entry.mesh.reset();
+                }
             }
+        }
+        it = m_outlines.emplace(key, std::move(entry)).first;
+    }
+
+    it->second.lastUsedFrame = m_frame;
+    return it->second.mesh ? &*it->second.mesh : nullptr;
+}
+
+size_t VulkanFontRenderer::OutlineKeyHash::operator()(const OutlineKey& key) const
+{
+    size_t seed = 0;
+    hash_combine(seed, key.glyphIndex);
+    hash_combine(seed, key.faceId);
+    return seed;
+}
+
+void VulkanFontRenderer::addTextInstances(
+    const TextBlob& text, Point start, const Pattern& pattern, const Transform2D& transform,
+    VulkanGlyphCache::GlyphFormat format
+) const
+{
+    // text space: centered on the layout box, so that transforms rotate and scale around its center
+    Point origin(-text.layoutSize.width / 2.0f, -text.layoutSize.height / 2.0f);
+    glm::mat4 model = textModelMatrix(transform, Point(
+        start.x + text.layoutSize.width / 2.0f,
+        start.y + text.layoutSize.height / 2.0f
+    ));
+    std::array<uint8_t, 4> color = instanceColor(pattern);
+
+    if (std::ranges::any_of(m_glyphMeshes, [](const GlyphOutline::Mesh* mesh) { return mesh != nullptr; }))
+    {
+        addOutlineGeometry(text, start, pattern, transform);
+    }
+
+    m_instances.clear();
+    for (size_t i = 0; i < text.glyphs.size(); ++i)
+    {
+        const std::optional<VulkanGlyphCache::GlyphInfo>& glyphInfo = m_glyphInfos[i];
+        // not rasterized (no atlas space left this frame) or nothing to draw
+        if (!glyphInfo || glyphInfo->uv.size.width == 0 || glyphInfo->uv.size.height == 0)
+        {
+            continue;
+        }
+
+        // distance fields are rasterized at a fixed size
+        float scale = text.fontEmSize / glyphInfo->rasterSize;
+        Point quadOrigin = glyphQuadOrigin(
+            text.glyphs[i].position, glyphInfo->left, glyphInfo->top, glyphInfo->bearingX, scale
         );
+        glm::vec4 pos = model * glm::vec4(origin.x + quadOrigin.x, origin.y + quadOrigin.y, 0.0f, 1.0f);
+        glm::vec4 axisX = model * glm::vec4(glyphInfo->width * scale, 0.0f, 0.0f, 0.0f);
+        glm::vec4 axisY = model * glm::vec4(0.0f, glyphInfo->height * scale, 0.0f, 0.0f);
 
-        indices.push_back(static_cast<uint16_t>(baseIndex));
-        indices.push_back(static_cast<uint16_t>(baseIndex + 1));
-        indices.push_back(static_cast<uint16_t>(baseIndex + 2));
-        indices.push_back(static_cast<uint16_t>(baseIndex + 2));
-        indices.push_back(static_cast<uint16_t>(baseIndex + 3));
-        indices.push_back(static_cast<uint16_t>(baseIndex));
+        m_instances.push_back({
+            .pos = {pos.x, pos.y},
+            .axisX = glm::packHalf2x16({axisX.x, axisX.y}),
+            .axisY = glm::packHalf2x16({axisY.x, axisY.y}),
+            .uvRect = {
+                toUnorm16(glyphInfo->uv.pos.x),
+                toUnorm16(glyphInfo->uv.pos.y),
+                toUnorm16(glyphInfo->uv.size.width),
+                toUnorm16(glyphInfo->uv.size.height),
+            },
+            .page = glyphInfo->page,
+            .color = color,
+        });
+    }
+
+    if (m_instances.empty())
+    {
+        return;
+    }
+
+    FragPushConstants fragData = createFragPushConstantData(pattern);
+    fragData.shapeType = static_cast<uint32_t>(
+        format == VulkanGlyphCache::GlyphFormat::DistanceField ? ShapeType::DistanceField : ShapeType::Nothing
+    );
+    if (fragData.patternType == static_cast<uint32_t>(PatternType::SolidColor))
+    {
+        // the color is in the instances. texts of any solid color share a draw
+        fragData.color = {};
     }
 
-    m_renderer->addCommand(
-        vertices, indices,
-        createFragPushConstantData(pattern),
-        createVertexPushConstantData(transform, Point(
+    m_renderer->addGlyphCommand(m_instances, fragData, pattern);
+}
+
+void VulkanFontRenderer::addOutlineGeometry(
+    const TextBlob& text, Point start, const Pattern& pattern, const Transform2D& transform
+) const
+{
+    // same text space as the glyph instances
+    Point origin(-text.layoutSize.width / 2.0f, -text.layoutSize.height / 2.0f);
+    VertexPushConstants vertData{
+        .model = toAffine2D(textModelMatrix(transform, Point(
             start.x + text.layoutSize.width / 2.0f,
             start.y + text.layoutSize.height / 2.0f
-        )),
-        pattern,
-        VulkanRendererImpl::PipelineType::Text
+        ))),
+    };
+    FragPushConstants fragData = createFragPushConstantData(pattern);
+    fragData.shapeType = static_cast<uint32_t>(ShapeType::Feathered);
+
+    m_outlineVertices.clear();
+    m_outlineIndices.clear();
+    for (size_t i = 0; i < text.glyphs.size(); ++i)
+    {
+        const GlyphOutline::Mesh* mesh = m_glyphMeshes[i];
+        if (!mesh || mesh->indices.empty())
+        {
+            continue;
+        }
+
+        // the feather is in pixels, like the feathered fills of paths
+        Point pen = origin + text.glyphs[i].position;
+        pen.x -= mesh->bearingX * text.fontEmSize;
+        auto base = static_cast<uint32_t>(m_outlineVertices.size());
+        for (const GlyphOutline::Mesh::Vertex& vertex : mesh->vertices)
+        {
+            m_outlineVertices.push_back({
+                .pos = {
+                    pen.x + vertex.position.x * text.fontEmSize + vertex.feather.x * VulkanTessellator::ANTIALIAS_WIDTH,
+                    pen.y + vertex.position.y * text.fontEmSize + vertex.feather.y * VulkanTessellator::ANTIALIAS_WIDTH,
+                },
+                .uv = {vertex.coverage, 0.0f},
+            });
+        }
+        for (uint32_t index : mesh->indices)
+        {
+            m_outlineIndices.push_back(base + index);
+        }
+    }
+
+    if (!m_outlineIndices.empty())
+    {
+        m_renderer->addCommand(
+            m_outlineVertices, m_outlineIndices, fragData, vertData, pattern,
+            VulkanRendererImpl::PipelineType::Geometry, VulkanRendererImpl::DrawLayer::Text
+        );
+    }
+}
+
+void VulkanFontRenderer::drawTextGrid(const TextGrid& grid, Point start) const
+{
+    if (!grid.fontFace())
+    {
+        return;
+    }
+
+    VulkanGlyphCache::GlyphFormat format = m_renderMode == TextRenderMode::DistanceField
+        ? VulkanGlyphCache::GlyphFormat::DistanceField
+        : VulkanGlyphCache::GlyphFormat::Coverage;
+
+    GridCache& cache = m_gridCaches[grid.id()];
+    cache.lastUsedFrame = m_frame;
+    if (updateGridRows(grid, format, cache) && m_pendingTexts.empty())
+    {
+        addGridInstances(grid, start, format, cache);
+        return;
+    }
+
+    // like drawText, wait for the missing glyphs
+    m_pendingTexts.emplace_back(PendingGrid{grid, start, format});
+}
+
+bool VulkanFontRenderer::updateGridRows(
+    const TextGrid& grid, VulkanGlyphCache::GlyphFormat format, GridCache& cache
+) const
+{
+    auto* ftFontFace = dynamic_cast<FreetypeFontFace*>(grid.fontFace().get());
+    if (!ftFontFace)
+    {
+        std::cerr << "Unsupported font face type in VulkanFontRenderer::drawTextGrid" << std::endl;
+        return true;
+    }
+
+    const TextGridMetrics& metrics = grid.metrics();
+    uint64_t faceId = grid.fontFace()->id();
+    uint64_t atlasGeneration = m_glyphCache->atlasGeneration();
+
+    bool complete = true;
+    cache.rows.resize(grid.rows());
+    for (uint32_t row = 0; row < grid.rows(); ++row)
+    {
+        uint32_t slot = grid.rowSlot(row);
+        GridRowCache& rowCache = cache.rows[slot];
+        if (rowCache.version == grid.slotVersion(slot) && rowCache.atlasGeneration == atlasGeneration
+            && rowCache.format == format)
+        {
+            continue;
+        }
+
+        bool rowComplete = true;
+        rowCache.pageMask = 0;
+        rowCache.instances.clear();
+        std::span<const TextGridCell> cells = grid.row(row);
+        for (uint32_t column = 0; column < cells.size(); ++column)
+        {
+            const TextGridCell& cell = cells[column];
+            if (cell.codepoint == U' ' || cell.codepoint == 0)
+            {
+                continue;
+            }
+
+            // one nominal glyph per cell. nothing is shaped
+            hb_codepoint_t glyphIndex = 0;
+            hb_font_get_nominal_glyph(ftFontFace->getHbFont(), cell.codepoint, &glyphIndex);
+            std::optional<VulkanGlyphCache::GlyphInfo> glyphInfo = m_glyphCache->findGlyph(
+                glyphIndex, faceId, grid.fontEmSize(), format
+            );
+            if (!glyphInfo)
+            {
+                m_glyphCache->requestGlyph(
+                    glyphIndex, faceId, grid.fontEmSize(), format, ftFontFace->face(), grid.fontFace()
+                );
+                rowComplete = false;
+                continue;
+            }
+            if (glyphInfo->uv.size.width == 0 || glyphInfo->uv.size.height == 0)
+            {
+                continue;
+            }
+
+            float scale = grid.fontEmSize() / glyphInfo->rasterSize;
+            rowCache.instances.push_back({
+                .pos = {
+                    column * metrics.cellSize.width + glyphInfo->left * scale,
+                    metrics.baseline - glyphInfo->top * scale,
+                },
+                .axisX = glm::packHalf2x16({glyphInfo->width * scale, 0.0f}),
+                .axisY = glm::packHalf2x16({0.0f, glyphInfo->height * scale}),
+                .uvRect = {
+                    toUnorm16(glyphInfo->uv.pos.x),
+                    toUnorm16(glyphInfo->uv.pos.y),
+                    toUnorm16(glyphInfo->uv.size.width),
+                    toUnorm16(glyphInfo->uv.size.height),
+                },
+                .page = glyphInfo->page,
+                .color = instanceColor(SolidColorPattern(cell.inverse ? cell.background : cell.foreground)),
+            });
+            rowCache.pageMask |= 1u << glyphInfo->page;
+        }
+
+        rowCache.version = rowComplete ? grid.slotVersion(slot) : 0;
+        rowCache.atlasGeneration = atlasGeneration;
+        rowCache.format = format;
+        complete = complete && rowComplete;
+    }
+
+    return complete;
+}
+
+void VulkanFontRenderer::addGridInstances(
+    const TextGrid& grid, Point start, VulkanGlyphCache::GlyphFormat format, const GridCache& cache
+) const
+{
+    m_instances.clear();
+    uint32_t pageMask = 0;
+    for (uint32_t row = 0; row < grid.rows(); ++row)
+    {
+        const GridRowCache& rowCache = cache.rows[grid.rowSlot(row)];
+        glm::vec2 rowOrigin(start.x, start.y + row * grid.metrics().cellSize.height);
+        for (VulkanPipeline::GlyphInstance instance : rowCache.instances)
+        {
+            instance.pos += rowOrigin;
+            m_instances.push_back(instance);
+        }
+        pageMask |= rowCache.pageMask;
+    }
+    // rows that were not rebuilt did not look their glyphs up this frame
+    m_glyphCache->touchPages(pageMask);
+
+    if (m_instances.empty())
+    {
+        return;
+    }
+
+    SolidColorPattern pattern(Color(0.0f, 0.0f, 0.0f, 1.0f));
+    FragPushConstants fragData = createFragPushConstantData(pattern);
+    fragData.shapeType = static_cast<uint32_t>(
+        format == VulkanGlyphCache::GlyphFormat::DistanceField ? ShapeType::DistanceField : ShapeType::Nothing
     );
+    // the colors are in the instances
+    fragData.color = {};
+
+    m_renderer->addGlyphCommand(m_instances, fragData, pattern);
+}
+
+void VulkanFontRenderer::setRenderMode(TextRenderMode mode)
+{
+    if (mode == TextRenderMode::DistanceField && !VulkanGlyphCache::supportsDistanceField())
+    {
+        std::cerr << "FreeType was built without SDF rendering. falling back to bitmap text" << std::endl;
+        return;
+    }
+    m_renderMode = mode;
 }
 } // karin
\ No newline at end of file
@@ -4,6 +4,13 @@
 #include "font_renderer_impl.h"
 
 #include "vulkan_glyph_cache.h"
+#include "vulkan_pipeline.h"
+#include "text/freetype/glyph_outline.h"
+
+#include <optional>
+#include <unordered_map>
+#include <variant>
+#include <vector>
 
 namespace karin
 {
@@ -15,7 +22,11 @@ public:
     explicit VulkanFontRenderer(VulkanRendererImpl *renderer, size_t maxFramesInFlight);
     ~VulkanFontRenderer() override;
 
+    // glyphs from OUTLINE_GLYPH_SIZE up are drawn as cached outline meshes, and take no atlas space
     void drawText(const TextBlob& text, Point start, const Pattern& pattern, const Transform2D& transform) const override;
+    // glyph instances of each row are kept between frames and rebuilt only when the row changes
+    void drawTextGrid(const TextGrid& grid, Point start) const override;
+    void setRenderMode(TextRenderMode mode) override;
 
     void cleanup() const;
 
@@ -24,10 +35,9 @@ public:
         return m_glyphCache->atlasDescriptorSetLayout();
     }
 
-    void flushGlyphUploads() const
-    {
-        m_glyphCache->flushUploadQueue();
-    }
+    // draw the texts that waited for glyphs and record the upload of new glyphs into commandBuffer.
+    // once per frame, before the render pass begins
+    void flushGlyphUploads(VkCommandBuffer commandBuffer, size_t frameIndex);
 
     std::vector<VkDescriptorSet> glyphAtlasDescriptorSets() const
     {
@@ -35,14 +45,100 @@ public:
     }
 
 private:
-    struct GlyphUploadPosition
+    struct PendingText
     {
-        // origin: top-left of the glyph bitmap
-        Rectangle position;
-        Rectangle atlasUV; // in [0, 1]
+        TextBlob text;
+        Point start;
+        Pattern pattern;
+        Transform2D transform;
+        VulkanGlyphCache::GlyphFormat format;
     };
 
+    struct PendingGrid
+    {
+        TextGrid grid;
+        Point start;
+        VulkanGlyphCache::GlyphFormat format;
+    };
+
+    struct GridRowCache
+    {
+        // TextGrid::slotVersion of the row. 0: not built
+        uint64_t version = 0;
+        uint64_t atlasGeneration = 0;
+        VulkanGlyphCache::GlyphFormat format = VulkanGlyphCache::GlyphFormat::Coverage;
+        // atlas pages the row samples. bit n: page n
+        uint32_t pageMask = 0;
+        // relative to the top-left corner of the row
+        std::vector<VulkanPipeline::GlyphInstance> instances;
+    };
+
+    struct GridCache
+    {
+        uint64_t lastUsedFrame = 0;
+        // by slot
+        std::vector<GridRowCache> rows;
+    };
+
+    // outlines are in em units, so every size shares them
+    struct OutlineKey
+    {
+        uint32_t glyphIndex;
+        uint64_t faceId;
+
+        bool operator==(const OutlineKey& other) const = default;
+    };
+
+    struct OutlineKeyHash
+    {
+        size_t operator()(const OutlineKey& key) const;
+    };
+
+    struct OutlineEntry
+    {
+        // nullopt: the glyph has no outline and goes through the atlas
+        std::optional<GlyphOutline::Mesh> mesh;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    // fill m_glyphInfos and m_glyphMeshes. false if a glyph is not cached yet
+    bool findGlyphs(const TextBlob& text, VulkanGlyphCache::GlyphFormat format) const;
+    // nullptr if the glyph has no outline. the outline is loaded and tessellated on first use
+    const GlyphOutline::Mesh* findOutline(const TextBlob& text, const GlyphPosition& glyph) const;
+    // from m_glyphInfos
+    void addTextInstances(
+        const TextBlob& text, Point start, const Pattern& pattern, const Transform2D& transform,
+        VulkanGlyphCache::GlyphFormat format
+    ) const;
+    // from m_glyphMeshes, through the geometry pipeline
+    void addOutlineGeometry(const TextBlob& text, Point start, const Pattern& pattern, const Transform2D& transform) const;
+    // rebuild the rows whose content or glyphs changed. false if a glyph is not cached yet
+    bool updateGridRows(const TextGrid& grid, VulkanGlyphCache::GlyphFormat format, GridCache& cache) const;
+    void addGridInstances(
+        const TextGrid& grid, Point start, VulkanGlyphCache::GlyphFormat format, const GridCache& cache
+    ) const;
+
     std::unique_ptr<VulkanGlyphCache> m_glyphCache;
+    TextRenderMode m_renderMode = TextRenderMode::Bitmap;
+
+    mutable std::vector<std::variant<PendingText, PendingGrid>> m_pendingTexts;
+    // per glyph of the text being drawn. reused between texts
+    mutable std::vector<std::optional<VulkanGlyphCache::GlyphInfo>> m_glyphInfos;
+    mutable std::vector<const GlyphOutline::Mesh*> m_glyphMeshes;
+    mutable std::vector<VulkanPipeline::GlyphInstance> m_instances;
+    mutable std::vector<VulkanPipeline::Vertex> m_outlineVertices;
+    mutable std::vector<uint32_t> m_outlineIndices;
+    // by TextGrid::id. dropped when a grid is not drawn in a frame
+    mutable std::unordered_map<uint64_t, GridCache> m_gridCaches;
+    mutable std::unordered_map<OutlineKey, OutlineEntry, OutlineKeyHash> m_outlines;
+    uint64_t m_frame = 0;
+
+    // em size in pixels. smaller glyphs are rasterized into the atlas
+    static constexpr float OUTLINE_GLYPH_SIZE = 128.0f;
+    // outlines not drawn in the frame are dropped once there are more
+    static constexpr size_t MAX_CACHED_OUTLINES = 2048;
+    // glyphs with more outline vertices are cheaper to draw from the atlas
+    static constexpr size_t MAX_OUTLINE_VERTICES = 65536;
 
     VulkanRendererImpl* m_renderer;
 };
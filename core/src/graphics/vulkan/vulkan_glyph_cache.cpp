@@ -2,14 +2,19 @@
 
 #include <utils/hash.h>
 
+#include <algorithm>
+#include <bit>
 #include <stdexcept>
 #include <cmath>
 #include <cstring>
+#include <iostream>
 
 namespace karin
 {
 VulkanGlyphCache::VulkanGlyphCache(size_t maxFramesInFlight)
-    : m_maxFramesInFlight(maxFramesInFlight)
+    : m_maxFramesInFlight(maxFramesInFlight),
+      m_rasterizer(std::make_unique<GlyphRasterizer>()),
+      m_stagingBuffers(maxFramesInFlight)
 {
     createDescriptorSetLayout();
     createSampler();
@@ -18,61 +23,168 @@ VulkanGlyphCache::VulkanGlyphCache(size_t maxFramesInFlight)
 
 void VulkanGlyphCache::cleanup()
 {
+    for (auto& staging : m_stagingBuffers)
+    {
+        if (staging.buffer)
+        {
+            vmaDestroyBuffer(VulkanContext::instance().allocator(), staging.buffer, staging.allocation);
+        }
+    }
+    m_stagingBuffers.clear();
+
     vmaDestroyImage(VulkanContext::instance().allocator(), m_atlasImage, m_atlasImageAllocation);
     vkDestroyImageView(VulkanContext::instance().device(), m_atlasImageView, nullptr);
     vkDestroySampler(VulkanContext::instance().device(), m_atlasSampler, nullptr);
     vkDestroyDescriptorSetLayout(VulkanContext::instance().device(), m_atlasDescriptorSetLayout, nullptr);
 }
 
-VulkanGlyphCache::GlyphInfo VulkanGlyphCache::getGlyph(uint32_t glyphIndex, uint32_t fontKey, FT_Face face, float size)
+std::optional<VulkanGlyphCache::GlyphInfo> VulkanGlyphCache::findGlyph(
+    uint32_t glyphIndex, uint64_t faceId, float size, GlyphFormat format
+)
 {
-    if (auto it = m_glyphMap.find(glyphKey(glyphIndex, fontKey, size)); it != m_glyphMap.end())
+    auto it = m_glyphMap.find(glyphKey(glyphIndex, faceId, size, format));
+    if (it == m_glyphMap.end())
     {
-        return it->second;
+        return std::nullopt;
     }
 
-    FT_Error error = FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT);
-    if (error)
+    it->second.lastUsedFrame = m_frame;
+    if (it->second.info.uv.size.width != 0)
+    {
+        m_pages[it->second.info.page].lastUsedFrame = m_frame;
+    }
+    return it->second.info;
+}
+
+void VulkanGlyphCache::requestGlyph(
+    uint32_t glyphIndex, uint64_t faceId, float size, GlyphFormat format,
+    FT_Face face, std::shared_ptr<const void> owner
+)
+{
+    GlyphKey key = glyphKey(glyphIndex, faceId, size, format);
+    // a deferred glyph is already rasterized
+    if (m_deferredGlyphs.contains(key) || !m_requestedKeys.insert(key).second)
+    {
+        return;
+    }
+
+    m_requests.push_back({
+        .face = face,
+        .owner = std::move(owner),
+        .glyphIndex = glyphIndex,
+        .size = format == GlyphFormat::DistanceField ? DISTANCE_FIELD_SIZE : size,
+        .format = format,
+        .spread = DISTANCE_FIELD_SPREAD,
+    });
+    m_requestKeys.push_back(key);
+}
+
+void VulkanGlyphCache::rasterizeRequestedGlyphs()
+{
+    std::erase_if(m_deferredGlyphs, [this](const auto& entry)
+    {
+        return addGlyph(entry.first, entry.second.rasterSize, entry.second.glyph);
+    });
+
+    if (m_requests.empty())
+    {
+        return;
+    }
+
+    std::vector<GlyphRasterizer::Glyph> glyphs = m_rasterizer->rasterize(m_requests);
+    for (size_t i = 0; i < glyphs.size(); ++i)
+    {
+        if (glyphs[i].error)
+        {
+            std::cerr << "failed to rasterize glyph " << m_requests[i].glyphIndex << ": " << glyphs[i].error << std::endl;
+        }
+        if (!addGlyph(m_requestKeys[i], m_requests[i].size, glyphs[i]))
+        {
+            m_deferredGlyphs.emplace(m_requestKeys[i], DeferredGlyph{m_requests[i].size, std::move(glyphs[i])});
+        }
+    }
+
+    m_requests.clear();
+    m_requestKeys.clear();
+    m_requestedKeys.clear();
+}
+
+bool VulkanGlyphCache::addGlyph(const GlyphKey& key, float rasterSize, const GlyphRasterizer::Glyph& glyph)
+{
+    int width = glyph.width;
+    int height = glyph.height;
+
+    if (width == 0 || height == 0)
     {
-        throw std::runtime_error("failed to load glyph");
+        // nothing to draw (e.g. space) or failed. cache it without atlas space
+        m_glyphMap[key] = GlyphEntry{GlyphInfo{}, m_frame};
+        return true;
     }
 
-    error = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
-    if (error)
+    int paddedWidth = width + GLYPH_PADDING * 2;
+    int paddedHeight = height + GLYPH_PADDING * 2;
+    if (paddedWidth > ATLAS_WIDTH || paddedHeight > ATLAS_HEIGHT)
     {
-        throw std::runtime_error("failed to render glyph");
+        // never fits. cached without atlas space so that it is not rasterized again
+        std::cerr << "glyph " << key.glyphIndex << " (" << width << "x" << height
+            << ") is larger than an atlas page and is not drawn" << std::endl;
+        m_glyphMap[key] = GlyphEntry{GlyphInfo{}, m_frame};
+        return true;
     }
 
-    FT_GlyphSlot slot = face->glyph;
-    Point atlasPos = allocateAtlasSpace(slot->bitmap.width, slot->bitmap.rows);
+    std::optional<AtlasSpace> space = allocateAtlasSpace(paddedWidth, paddedHeight);
+    if (!space)
+    {
+        if (!m_reportedFullAtlas)
+        {
+            std::cerr << "glyph atlas is full. glyphs are drawn once a page is no longer in use" << std::endl;
+            m_reportedFullAtlas = true;
+        }
+        return false;
+    }
 
     GlyphInfo info = {
         .uv = Rectangle(
-            atlasPos.x / ATLAS_WIDTH,
-            atlasPos.y / ATLAS_HEIGHT,
-            static_cast<float>(slot->bitmap.width) / ATLAS_WIDTH,
-            static_cast<float>(slot->bitmap.rows) / ATLAS_HEIGHT
+            (space->position.x + GLYPH_PADDING) / ATLAS_WIDTH,
+            (space->position.y + GLYPH_PADDING) / ATLAS_HEIGHT,
+            static_cast<float>(width) / ATLAS_WIDTH,
+            static_cast<float>(height) / ATLAS_HEIGHT
         ),
-        .width = static_cast<float>(slot->bitmap.width),
-        .height = static_cast<float>(slot->bitmap.rows),
+        .page = space->page,
+        .width = static_cast<float>(width),
+        .height = static_cast<float>(height),
+        .left = static_cast<float>(glyph.left),
+        .top = static_cast<float>(glyph.top),
+        .bearingX = glyph.bearingX,
+        .rasterSize = rasterSize,
     };
-    m_glyphMap[glyphKey(glyphIndex, fontKey, size)] = info;
+    m_glyphMap[key] = GlyphEntry{info, m_frame};
+    m_pages[space->page].glyphKeys.push_back(key);
+    m_pages[space->page].lastUsedFrame = m_frame;
 
-    std::vector<std::byte> bitmapData(slot->bitmap.width * slot->bitmap.rows);
-    std::memcpy(bitmapData.data(), slot->bitmap.buffer, bitmapData.size());
+    // upload the padding too, so it is cleared even if the page held other glyphs before
+    std::vector<std::byte> bitmapData(static_cast<size_t>(paddedWidth) * paddedHeight);
+    for (int row = 0; row < height; ++row)
+    {
+        std::memcpy(
+            bitmapData.data() + static_cast<size_t>(row + GLYPH_PADDING) * paddedWidth + GLYPH_PADDING,
+            glyph.bitmap.data() + static_cast<size_t>(row) * width,
+            width
+        );
+    }
 
     GlyphUploadInfo uploadInfo = {
         .bitmapData = std::move(bitmapData),
-        .width = static_cast<int>(slot->bitmap.width),
-        .height = static_cast<int>(slot->bitmap.rows),
-        .atlasRegion = atlasPos,
+        .width = paddedWidth,
+        .height = paddedHeight,
+        .atlasRegion = space->position,
+        .page = space->page,
     };
     m_uploadQueue.push_back(std::move(uploadInfo));
-
-    return info;
+    return true;
 }
 
-void VulkanGlyphCache::flushUploadQueue()
+void VulkanGlyphCache::flushUploadQueue(VkCommandBuffer commandBuffer, size_t frameIndex)
 {
     if (m_uploadQueue.empty())
     {
@@ -85,44 +197,26 @@ void VulkanGlyphCache::flushUploadQueue()
         totalSize += upload.bitmapData.size();
     }
 
-    VkBuffer stagingBuffer;
-    VmaAllocation stagingBufferMemory;
-    VmaAllocationCreateInfo stagingBufferAllocationInfo = {
-        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-        .usage = VMA_MEMORY_USAGE_AUTO,
-    };
-    VkBufferCreateInfo bufferInfo = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size = totalSize,
-        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-    };
-    if (vmaCreateBuffer(
-        VulkanContext::instance().allocator(), &bufferInfo, &stagingBufferAllocationInfo, &stagingBuffer, &stagingBufferMemory, nullptr
-    ) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to create staging buffer for glyph upload");
-    }
-
-    void* mappedData;
-    if (vmaMapMemory(VulkanContext::instance().allocator(), stagingBufferMemory, &mappedData) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to map memory for glyph upload staging buffer");
-    }
-
+    StagingBuffer& staging = stagingBuffer(frameIndex, totalSize);
+    std::byte* mappedData = staging.mapped;
     for (const auto& upload : m_uploadQueue)
     {
         std::memcpy(mappedData, upload.bitmapData.data(), upload.bitmapData.size());
-        mappedData = static_cast<std::byte*>(mappedData) + upload.bitmapData.size();
+        mappedData += upload.bitmapData.size();
     }
-    vmaUnmapMemory(VulkanContext::instance().allocator(), stagingBufferMemory);
+    vmaFlushAllocation(VulkanContext::instance().allocator(), staging.allocation, 0, totalSize);
 
-    VkCommandBuffer commandBuffer = VulkanContext::instance().beginSingleTimeCommands();
+    // waits for the fragment shaders of earlier submissions that sample the atlas
     transitionLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
     size_t offset = 0;
     for (const auto& upload : m_uploadQueue)
     {
+        if (upload.width == 0 || upload.height == 0)
+        {
+            continue;
+        }
+
         VkBufferImageCopy region = {
             .bufferOffset = offset,
             .bufferRowLength = 0,
@@ -130,7 +224,7 @@ void VulkanGlyphCache::flushUploadQueue()
             .imageSubresource = {
                 .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
                 .mipLevel = 0,
-                .baseArrayLayer = 0,
+                .baseArrayLayer = upload.page,
                 .layerCount = 1,
             },
             .imageOffset = {
@@ -145,57 +239,164 @@ void VulkanGlyphCache::flushUploadQueue()
             },
         };
 
-        if (upload.width == 0 || upload.height == 0)
-        {
-            offset += 0;
-            continue;
-        }
-
         vkCmdCopyBufferToImage(
-            commandBuffer, stagingBuffer, m_atlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region
+            commandBuffer, staging.buffer, m_atlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region
         );
         offset += upload.bitmapData.size();
     }
 
     transitionLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    VulkanContext::instance().endSingleTimeCommands(commandBuffer);
-
-    vmaDestroyBuffer(VulkanContext::instance().allocator(), stagingBuffer, stagingBufferMemory);
 
     m_uploadQueue.clear();
 }
 
-size_t VulkanGlyphCache::glyphKey(uint32_t glyphIndex, uint32_t fontKey, float size)
+VulkanGlyphCache::StagingBuffer& VulkanGlyphCache::stagingBuffer(size_t frameIndex, VkDeviceSize size)
 {
-    auto sizeInt = static_cast<uint32_t>(std::round(size * SIZE_FLOAT_ACCURACY));
+    StagingBuffer& staging = m_stagingBuffers[frameIndex];
+    if (staging.size >= size)
+    {
+        return staging;
+    }
 
-    size_t seed = 0;
+    // the frame that last used it has completed, so it can be replaced right away
+    if (staging.buffer)
+    {
+        vmaDestroyBuffer(VulkanContext::instance().allocator(), staging.buffer, staging.allocation);
+        staging = {};
+    }
 
-    hash_combine(seed, glyphIndex);
-    hash_combine(seed, fontKey);
-    hash_combine(seed, sizeInt);
+    VkDeviceSize bufferSize = std::max(std::bit_ceil(size), MIN_STAGING_BUFFER_SIZE);
+    VmaAllocationCreateInfo allocationInfo = {
+        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_AUTO,
+    };
+    VkBufferCreateInfo bufferInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = bufferSize,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    VmaAllocationInfo memoryInfo;
+    if (vmaCreateBuffer(
+        VulkanContext::instance().allocator(), &bufferInfo, &allocationInfo, &staging.buffer, &staging.allocation, &memoryInfo
+    ) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create staging buffer for glyph upload");
+    }
+
+    staging.mapped = static_cast<std::byte*>(memoryInfo.pMappedData);
+    staging.size = bufferSize;
+    return staging;
+}
+
+VulkanGlyphCache::GlyphKey VulkanGlyphCache::glyphKey(
+    uint32_t glyphIndex, uint64_t faceId, float size, GlyphFormat format
+)
+{
+    // a distance field serves every size
+    auto sizeInt = format == GlyphFormat::DistanceField
+        ? 0u
+        : static_cast<uint32_t>(std::round(size * SIZE_FLOAT_ACCURACY));
+
+    return {
+        .glyphIndex = glyphIndex,
+        .faceId = faceId,
+        .size = sizeInt,
+        .format = format,
+    };
+}
 
+size_t VulkanGlyphCache::GlyphKeyHash::operator()(const GlyphKey& key) const
+{
+    size_t seed = 0;
+    hash_combine(seed, key.glyphIndex);
+    hash_combine(seed, key.faceId);
+    hash_combine(seed, key.size);
+    hash_combine(seed, static_cast<uint32_t>(key.format));
     return seed;
 }
 
-Point VulkanGlyphCache::allocateAtlasSpace(int width, int height)
+void VulkanGlyphCache::advanceFrame()
+{
+    ++m_frame;
+}
+
+void VulkanGlyphCache::touchPages(uint32_t pageMask)
+{
+    for (uint32_t page = 0; page < m_pages.size(); ++page)
+    {
+        if (pageMask & (1u << page))
+        {
+            m_pages[page].lastUsedFrame = m_frame;
+        }
+    }
+}
+
+std::optional<VulkanGlyphCache::AtlasSpace> VulkanGlyphCache::allocateAtlasSpace(int width, int height)
 {
-    if (m_currentX + width > ATLAS_WIDTH)
+    for (uint32_t page = 0; page < m_pages.size(); ++page)
+    {
+        if (auto position = m_pages[page].packer.pack(width, height))
+        {
+            return AtlasSpace{page, Point(position->x, position->y)};
+        }
+    }
+
+    std::optional<uint32_t> page;
+    if (m_pages.size() < MAX_ATLAS_PAGES)
+    {
+        m_pages.emplace_back();
+        page = static_cast<uint32_t>(m_pages.size() - 1);
+    }
+    else
+    {
+        page = evictPage();
+    }
+
+    if (!page)
+    {
+        return std::nullopt;
+    }
+
+    if (auto position = m_pages[*page].packer.pack(width, height))
+    {
+        return AtlasSpace{*page, Point(position->x, position->y)};
+    }
+    return std::nullopt;
+}
+
+std::optional<uint32_t> VulkanGlyphCache::evictPage()
+{
+    std::optional<uint32_t> coldest;
+    for (uint32_t page = 0; page < m_pages.size(); ++page)
+    {
+        // frames still in flight may sample this page
+        if (m_frame - m_pages[page].lastUsedFrame <= m_maxFramesInFlight)
+        {
+            continue;
+        }
+
+        if (!coldest || m_pages[page].lastUsedFrame < m_pages[*coldest].lastUsedFrame)
+        {
+            coldest = page;
+        }
+    }
+
+    if (!coldest)
     {
-        m_currentX = 0.0f;
-        m_currentY += m_rowHeight;
-        m_rowHeight = 0.0f;
+        return std::nullopt;
     }
 
-    Point position(m_currentX, m_currentY);
-    m_currentX += width;
-    m_rowHeight = std::max(m_rowHeight, height);
-    if (m_currentY + m_rowHeight > ATLAS_HEIGHT)
+    AtlasPage& atlasPage = m_pages[*coldest];
+    for (const GlyphKey& key : atlasPage.glyphKeys)
     {
-        throw std::runtime_error("glyph atlas is full");
+        m_glyphMap.erase(key);
     }
+    atlasPage.glyphKeys.clear();
+    atlasPage.packer.reset();
+    ++m_atlasGeneration;
 
-    return position;
+    return coldest;
 }
 
 void VulkanGlyphCache::createAtlas()
@@ -210,7 +411,7 @@ void VulkanGlyphCache::createAtlas()
         .format = VK_FORMAT_R8_UNORM,
         .extent = {ATLAS_WIDTH, ATLAS_HEIGHT, 1},
         .mipLevels = 1,
-        .arrayLayers = 1,
+        .arrayLayers = MAX_ATLAS_PAGES,
         .samples = VK_SAMPLE_COUNT_1_BIT,
         .tiling = VK_IMAGE_TILING_OPTIMAL,
         .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
@@ -227,7 +428,7 @@ void VulkanGlyphCache::createAtlas()
     VkImageViewCreateInfo viewInfo = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
         .image = m_atlasImage,
-        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY,
         .format = VK_FORMAT_R8_UNORM,
         .components = {
             .r = VK_COMPONENT_SWIZZLE_IDENTITY,
@@ -240,7 +441,7 @@ void VulkanGlyphCache::createAtlas()
             .baseMipLevel = 0,
             .levelCount = 1,
             .baseArrayLayer = 0,
-            .layerCount = 1,
+            .layerCount = MAX_ATLAS_PAGES,
         },
     };
     if (vkCreateImageView(VulkanContext::instance().device(), &viewInfo, nullptr, &m_atlasImageView) != VK_SUCCESS)
@@ -352,7 +553,7 @@ void VulkanGlyphCache::transitionLayout(VkCommandBuffer commandBuffer, VkImageLa
             .baseMipLevel = 0,
             .levelCount = 1,
             .baseArrayLayer = 0,
-            .layerCount = 1,
+            .layerCount = MAX_ATLAS_PAGES,
         },
     };
 
@@ -2,20 +2,37 @@
 #define SRC_GRAPHICS_VULKAN_VULKAN_GLYPH_CACHE_H
 
 #include "vulkan_context.h"
+#include "skyline_packer.h"
+#include "text/freetype/glyph_rasterizer.h"
 
 #include <karin/common/geometry/rectangle.h>
 #include <karin/common/geometry/point.h>
 
 #include <vulkan/vulkan.h>
 #include <vulkan/vma.h>
-#include <ft2build.h>
-#include FT_FREETYPE_H
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <vector>
 
 namespace karin
 {
+/*
+ * Glyph bitmaps live in a 2D array image, one layer per atlas page, packed with a skyline packer.
+ * When every page is full, the least recently used page that no frame in flight samples is cleared.
+ * If no page can be cleared the glyph is skipped for this frame, and its bitmap is kept to be placed on
+ * a later frame. A glyph larger than a page is cached with nothing to draw.
+ *
+ * A glyph is stored either as coverage rasterized at the drawn size, or as a signed distance field
+ * rasterized once at DISTANCE_FIELD_SIZE that serves every size and transform.
+ *
+ * Missing glyphs are requested while the frame is recorded and rasterized together on worker threads.
+ * Their uploads are recorded into the frame's command buffer before its render pass, through a staging
+ * buffer owned by that frame in flight, so adding glyphs never waits for the GPU.
+ */
 class VulkanGlyphCache
 {
 public:
@@ -24,13 +41,27 @@ public:
 
     void cleanup();
 
+    static constexpr bool supportsDistanceField()
+    {
+        return GlyphRasterizer::supportsDistanceField();
+    }
+
+    using GlyphFormat = GlyphRasterizer::Format;
+
     struct GlyphInfo
     {
-        // coordinates in the atlas. 0.0 - 1.0
+        // coordinates in the atlas page. 0.0 - 1.0
         Rectangle uv{};
+        uint32_t page = 0;
 
+        // bitmap in pixels at rasterSize. left/top: offset from the pen position, y up
         float width = 0.0f;
         float height = 0.0f;
+        float left = 0.0f;
+        float top = 0.0f;
+        // left bearing in pixels at rasterSize
+        float bearingX = 0.0f;
+        float rasterSize = 0.0f;
     };
 
     struct GlyphUploadInfo
@@ -40,10 +71,33 @@ public:
         int height = 0;
 
         Point atlasRegion{0.0f, 0.0f};
+        uint32_t page = 0;
     };
 
-    GlyphInfo getGlyph(uint32_t glyphIndex, uint32_t fontKey, FT_Face face, float size);
-    void flushUploadQueue();
+    // nullopt if the glyph is not cached yet. a glyph with an empty uv has nothing to draw
+    std::optional<GlyphInfo> findGlyph(uint32_t glyphIndex, uint64_t faceId, float size, GlyphFormat format);
+    // queue a missing glyph for rasterizeRequestedGlyphs. owner keeps face alive until then
+    void requestGlyph(
+        uint32_t glyphIndex, uint64_t faceId, float size, GlyphFormat format,
+        FT_Face face, std::shared_ptr<const void> owner
+    );
+    // rasterize the requested glyphs in parallel and queue their uploads.
+    // a glyph that finds no atlas space stays missing until a later call finds space for it
+    void rasterizeRequestedGlyphs();
+    // record the queued uploads into commandBuffer. must be outside a render pass.
+    // frameIndex: the frame in flight that owns commandBuffer. its previous submission must have completed
+    void flushUploadQueue(VkCommandBuffer commandBuffer, size_t frameIndex);
+    // call once per frame after the frame's glyphs were requested
+    void advanceFrame();
+
+    // changes whenever a page is cleared, which invalidates GlyphInfos kept outside the cache
+    uint64_t atlasGeneration() const
+    {
+        return m_atlasGeneration;
+    }
+
+    // keep pages sampled this frame through kept GlyphInfos from eviction. bit n: page n
+    void touchPages(uint32_t pageMask);
 
     std::vector<VkDescriptorSet> atlasDescriptorSets() const
     {
@@ -56,24 +110,99 @@ public:
     }
 
 private:
-    static size_t glyphKey(uint32_t glyphIndex, uint32_t fontKey, float size);
+    struct GlyphKey
+    {
+        uint32_t glyphIndex;
+        uint64_t faceId;
+        // size * SIZE_FLOAT_ACCURACY. 0 for distance fields, which serve every size
+        uint32_t size;
+        GlyphFormat format;
 
-    Point allocateAtlasSpace(int width, int height);
+        bool operator==(const GlyphKey& other) const = default;
+    };
+
+    struct GlyphKeyHash
+    {
+        size_t operator()(const GlyphKey& key) const;
+    };
+
+    struct GlyphEntry
+    {
+        GlyphInfo info;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    struct AtlasPage
+    {
+        SkylinePacker packer{ATLAS_WIDTH, ATLAS_HEIGHT};
+        // max of lastUsedFrame over the glyphs in this page
+        uint64_t lastUsedFrame = 0;
+        std::vector<GlyphKey> glyphKeys;
+    };
+
+    // rasterized, but no atlas page could be cleared for it
+    struct DeferredGlyph
+    {
+        float rasterSize;
+        GlyphRasterizer::Glyph glyph;
+    };
+
+    struct AtlasSpace
+    {
+        uint32_t page;
+        Point position;
+    };
+
+    struct StagingBuffer
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        std::byte* mapped = nullptr;
+        VkDeviceSize size = 0;
+    };
+
+    static GlyphKey glyphKey(uint32_t glyphIndex, uint64_t faceId, float size, GlyphFormat format);
+    // false if no atlas space was found
+    bool addGlyph(const GlyphKey& key, float rasterSize, const GlyphRasterizer::Glyph& glyph);
+
+    std::optional<AtlasSpace> allocateAtlasSpace(int width, int height);
+    std::optional<uint32_t> evictPage();
 
     void createAtlas();
     void createDescriptorSetLayout();
     void createSampler();
+    // grows the staging buffer of frameIndex to hold at least size bytes
+    StagingBuffer& stagingBuffer(size_t frameIndex, VkDeviceSize size);
     void transitionLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout);
 
     static constexpr int ATLAS_WIDTH = 2048;
     static constexpr int ATLAS_HEIGHT = 2048;
+    static constexpr uint32_t MAX_ATLAS_PAGES = 4;
+    // empty texels around each glyph so that linear filtering does not bleed into neighbours
+    static constexpr int GLYPH_PADDING = 1;
 
     static constexpr float SIZE_FLOAT_ACCURACY = 100.0f;
+    static constexpr VkDeviceSize MIN_STAGING_BUFFER_SIZE = 1 << 20;
+
+    // em size distance fields are rasterized at, and the distance in pixels they cover on each side of the outline
+    static constexpr float DISTANCE_FIELD_SIZE = 64.0f;
+    static constexpr int DISTANCE_FIELD_SPREAD = 8;
 
     size_t m_maxFramesInFlight = 2;
 
-    std::unordered_map<size_t, GlyphInfo> m_glyphMap;
+    std::unordered_map<GlyphKey, GlyphEntry, GlyphKeyHash> m_glyphMap;
+    std::unique_ptr<GlyphRasterizer> m_rasterizer;
+    std::vector<GlyphRasterizer::Request> m_requests;
+    std::vector<GlyphKey> m_requestKeys;
+    std::unordered_set<GlyphKey, GlyphKeyHash> m_requestedKeys;
+    std::unordered_map<GlyphKey, DeferredGlyph, GlyphKeyHash> m_deferredGlyphs;
+    bool m_reportedFullAtlas = false;
     std::vector<GlyphUploadInfo> m_uploadQueue;
+    // one per frame in flight, persistently mapped
+    std::vector<StagingBuffer> m_stagingBuffers;
+    std::vector<AtlasPage> m_pages;
+    uint64_t m_frame = 0;
+    uint64_t m_atlasGeneration = 0;
 
     VkImage m_atlasImage = VK_NULL_HANDLE;
     VmaAllocation m_atlasImageAllocation = VK_NULL_HANDLE;
@@ -82,10 +211,6 @@ private:
     std::vector<VkDescriptorSet> m_atlasDescriptorSets; // One per frame in flight
     VkSampler m_atlasSampler = VK_NULL_HANDLE;
     VkDescriptorSetLayout m_atlasDescriptorSetLayout = VK_NULL_HANDLE;
-
-    int m_currentX = 0;
-    int m_currentY = 0;
-    int m_rowHeight = 0;
 };
 } // karin
 
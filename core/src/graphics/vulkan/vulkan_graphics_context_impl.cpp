@@ -1,5 +1,6 @@
 #include "vulkan_graphics_context_impl.h"
 
+#include "corner_join.h"
 #include "glm_geometry.h"
 #include "vulkan_renderer_impl.h"
 #include "vulkan_tessellator.h"
@@ -8,12 +9,14 @@
 #include <karin/common/color/color.h>
 #include <karin/common/geometry/point.h>
 #include <karin/common/geometry/rectangle.h>
+#include <karin/common/geometry/size.h>
 #include <karin/graphics/pattern.h>
 #include <karin/graphics/stroke_style.h>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <iostream>
-#include <numbers>
 #include <stdexcept>
 #include <variant>
 #include <glm/glm.hpp>
@@ -69,6 +72,36 @@ FragPushConstants createFragPushConstantData(const Pattern& pattern)
     );
 }
 
+FragPushConstants createStrokeFragPushConstantData(const Pattern& pattern, const StrokeStyle& strokeStyle)
+{
+    auto fragData = createFragPushConstantData(pattern);
+    fragData.shapeType = static_cast<uint32_t>(ShapeType::Stroke);
+    fragData.strokeWidth = strokeStyle.width;
+    fragData.dashOffset = strokeStyle.dash_offset;
+    fragData.dashCapStyle = static_cast<uint32_t>(strokeStyle.dash_cap_style);
+
+    // an odd pattern is repeated to alternate dashes and gaps
+    const auto& dashPattern = strokeStyle.dash_pattern;
+    size_t dashCount = dashPattern.size() % 2 == 0 ? dashPattern.size() : dashPattern.size() * 2;
+    if (dashCount > MAX_DASH_PATTERN_LENGTH)
+    {
+        static bool reported = false;
+        if (!reported)
+        {
+            std::cerr << "dash patterns of more than " << MAX_DASH_PATTERN_LENGTH
+                << " lengths (odd patterns count twice) are not supported. drawing the stroke solid" << std::endl;
+            reported = true;
+        }
+        return fragData;
+    }
+    for (size_t i = 0; i < dashCount; ++i)
+    {
+        fragData.dashPattern[i / 4][i % 4] = dashPattern[i % dashPattern.size()];
+    }
+
+    return fragData;
+}
+
 VertexPushConstants createVertexPushConstantData(const Transform2D& transform, const Point& position)
 {
     glm::mat4 translateMatrix = glm::translate(
@@ -76,46 +109,105 @@ VertexPushConstants createVertexPushConstantData(const Transform2D& transform, c
         glm::vec3(position.x, position.y, 0.0f)
     );
     return VertexPushConstants{
-        .model = translateMatrix * glm::make_mat4(transform.colMajorData())
+        .model = toAffine2D(translateMatrix * glm::make_mat4(transform.colMajorData()))
     };
 }
-}
 
-namespace karin
-{
-VulkanGraphicsContextImpl::VulkanGraphicsContextImpl(VulkanRendererImpl* renderer)
-    : m_renderer(renderer)
+// quad around the origin, grown by the anti-aliasing margin. uv is -1..1 on the shape bounds
+std::vector<VulkanPipeline::Vertex> createShapeQuad(float halfWidth, float halfHeight)
 {
-}
+    float extentX = halfWidth + VulkanTessellator::ANTIALIAS_WIDTH;
+    float extentY = halfHeight + VulkanTessellator::ANTIALIAS_WIDTH;
+    float uvX = halfWidth > 0.0f ? extentX / halfWidth : 1.0f;
+    float uvY = halfHeight > 0.0f ? extentY / halfHeight : 1.0f;
 
-void VulkanGraphicsContextImpl::fillRect(Rectangle rect, const Pattern& pattern, const Transform2D& transform)
-{
-    std::vector<VulkanPipeline::Vertex> vertices = {
+    return {
         {
-            .pos = {-rect.size.width / 2.0f, -rect.size.height / 2.0f},
-            .uv = {-1.0f, -1.0f},
+            .pos = {-extentX, -extentY},
+            .uv = {-uvX, -uvY},
         },
         {
-            .pos = {rect.size.width / 2.0f, -rect.size.height / 2.0f},
-            .uv = {1.0f, -1.0f},
+            .pos = {extentX, -extentY},
+            .uv = {uvX, -uvY},
         },
         {
-            .pos = {rect.size.width / 2.0f, rect.size.height / 2.0f},
-            .uv = {1.0f, 1.0f},
+            .pos = {extentX, extentY},
+            .uv = {uvX, uvY},
         },
         {
-            .pos = { -rect.size.width / 2.0f, rect.size.height / 2.0f},
-            .uv = {-1.0f, 1.0f},
+            .pos = {-extentX, extentY},
+            .uv = {-uvX, uvY},
         }
     };
+}
+
+// start point, line ends and arc points in drawing order
+std::vector<Point> flattenPath(const PathImpl& path)
+{
+    std::vector<Point> points;
+    points.reserve(path.points().size() + 1);
+    points.push_back(path.startPoint());
+
+    for (const auto& command : path.commands())
+    {
+        if (command.isLine())
+        {
+            Point end = command.line().end;
+            if (points.back() != end)
+            {
+                points.push_back(end);
+            }
+            continue;
+        }
+
+        auto args = command.arc();
+        bool isClockwise = args.isSmallArc
+                               ? (args.endAngle < args.startAngle)
+                               : (args.endAngle > args.startAngle);
+
+        auto arcPoints = VulkanTessellator::splitArc(
+            args.center,
+            args.radiusX,
+            args.radiusY,
+            args.startAngle,
+            args.endAngle,
+            isClockwise
+        );
+
+        for (auto point : arcPoints)
+        {
+            if (points.back() != point)
+            {
+                points.push_back(point);
+            }
+        }
+    }
+
+    return points;
+}
+}
+
+namespace karin
+{
+VulkanGraphicsContextImpl::VulkanGraphicsContextImpl(VulkanRendererImpl* renderer)
+    : m_renderer(renderer)
+{
+}
 
-    std::vector<uint16_t> indices = {
+void VulkanGraphicsContextImpl::fillRect(Rectangle rect, const Pattern& pattern, const Transform2D& transform)
+{
+    auto vertices = createShapeQuad(rect.size.width / 2.0f, rect.size.height / 2.0f);
+
+    std::vector<uint32_t> indices = {
         0, 1, 2, 2, 3, 0
     };
 
+    auto fragData = createFragPushConstantData(pattern);
+    fragData.shapeType = static_cast<uint32_t>(ShapeType::Rectangle);
+
     m_renderer->addCommand(
         vertices, indices,
-        createFragPushConstantData(pattern),
+        fragData,
         createVertexPushConstantData(transform, Point(
             rect.pos.x + rect.size.width / 2.0f,
             rect.pos.y + rect.size.height / 2.0f
@@ -129,26 +221,9 @@ void VulkanGraphicsContextImpl::fillEllipse(
     Point center, float radiusX, float radiusY, const Pattern& pattern, const Transform2D& transform
 )
 {
-    std::vector<VulkanPipeline::Vertex> vertices = {
-        {
-            .pos = {-radiusX, -radiusY},
-            .uv = {-1.0f, -1.0f},
-        },
-        {
-            .pos = {radiusX, -radiusY},
-            .uv = {1.0f, -1.0f},
-        },
-        {
-            .pos = {radiusX, radiusY},
-            .uv = {1.0f, 1.0f},
-        },
-        {
-            .pos = { -radiusX, radiusY},
-            .uv = {-1.0f, 1.0f},
-        }
-    };
+    auto vertices = createShapeQuad(radiusX, radiusY);
 
-    std::vector<uint16_t> indices = {
+    std::vector<uint32_t> indices = {
         0, 1, 2, 2, 3, 0
     };
 
@@ -168,26 +243,9 @@ void VulkanGraphicsContextImpl::fillRoundedRect(
     Rectangle rect, float radiusX, float radiusY, const Pattern& pattern, const Transform2D& transform
 )
 {
-    std::vector<VulkanPipeline::Vertex> vertices = {
-        {
-            .pos = {-rect.size.width / 2.0f, -rect.size.height / 2.0f},
-            .uv = {-1.0f, -1.0f},
-        },
-        {
-            .pos = {rect.size.width / 2.0f, -rect.size.height / 2.0f},
-            .uv = {1.0f, -1.0f},
-        },
-        {
-            .pos = {rect.size.width / 2.0f, rect.size.height / 2.0f},
-            .uv = {1.0f, 1.0f},
-        },
-        {
-            .pos = { -rect.size.width / 2.0f, rect.size.height / 2.0f},
-            .uv = {-1.0f, 1.0f},
-        }
-    };
+    auto vertices = createShapeQuad(rect.size.width / 2.0f, rect.size.height / 2.0f);
 
-    std::vector<uint16_t> indices = {
+    std::vector<uint32_t> indices = {
         0, 1, 2, 2, 3, 0
     };
 
@@ -212,21 +270,16 @@ void VulkanGraphicsContextImpl::drawLine(
 )
 {
     std::vector<VulkanPipeline::Vertex> vertices;
-    std::vector<uint16_t> indices;
+    std::vector<uint32_t> indices;
 
-    VulkanTessellator::addLine(
-        Point(start.x - (start.x + end.x) / 2, start.y - (start.y + end.y) / 2),
-        Point(end.x - (start.x + end.x) / 2, end.y - (start.y + end.y) / 2),
-        strokeStyle, vertices, indices
-    );
+    Point center((start.x + end.x) / 2.0f, (start.y + end.y) / 2.0f);
+    std::array<Point, 2> points = {start - center, end - center};
+    VulkanTessellator::addPolyline(points, false, strokeStyle, vertices, indices);
 
     m_renderer->addCommand(
         vertices, indices,
-        createFragPushConstantData(pattern),
-        createVertexPushConstantData(transform, Point(
-            (start.x + end.x) / 2.0f,
-            (start.y + end.y) / 2.0f
-        )),
+        createStrokeFragPushConstantData(pattern, strokeStyle),
+        createVertexPushConstantData(transform, center),
         pattern,
         VulkanRendererImpl::PipelineType::Geometry
     );
@@ -236,53 +289,14 @@ void VulkanGraphicsContextImpl::drawRect(
     Rectangle rect, const Pattern& pattern, const StrokeStyle& strokeStyle, const Transform2D& transform
 )
 {
-    std::vector<VulkanPipeline::Vertex> vertices;
-    std::vector<uint16_t> indices;
-
-    StrokeStyle style = strokeStyle;
-    style.start_cap_style = style.dash_cap_style;
-    style.end_cap_style = style.dash_cap_style;
-    float dashOffset = VulkanTessellator::addLine(
-        Point(-rect.size.width / 2.0f, -rect.size.height / 2.0f),
-        Point(rect.size.width / 2.0f, -rect.size.height / 2.0f),
-        style,
-        vertices,
-        indices
-    );
-    style.dash_offset = dashOffset;
-    dashOffset = VulkanTessellator::addLine(
-        Point(rect.size.width / 2.0f, -rect.size.height / 2.0f),
-        Point(rect.size.width / 2.0f, rect.size.height / 2.0f),
-        style,
-        vertices,
-        indices
-    );
-    style.dash_offset = dashOffset;
-    dashOffset = VulkanTessellator::addLine(
-        Point(rect.size.width / 2.0f, rect.size.height / 2.0f),
-        Point(-rect.size.width / 2.0f, rect.size.height / 2.0f),
-        style,
-        vertices,
-        indices
-    );
-    style.dash_offset = dashOffset;
-    VulkanTessellator::addLine(
-        Point(-rect.size.width / 2.0f, rect.size.height / 2.0f),
-        Point(-rect.size.width / 2.0f, -rect.size.height / 2.0f),
-        style,
-        vertices,
-        indices
-    );
-
-    m_renderer->addCommand(
-        vertices, indices,
-        createFragPushConstantData(pattern),
-        createVertexPushConstantData(transform, Point(
-            rect.pos.x + rect.size.width / 2.0f,
-            rect.pos.y + rect.size.height / 2.0f
-        )),
+    strokeRoundedRect(
+        Point(rect.pos.x + rect.size.width / 2.0f, rect.pos.y + rect.size.height / 2.0f),
+        Size{rect.size.width / 2.0f, rect.size.height / 2.0f},
+        0.0f,
+        0.0f,
         pattern,
-        VulkanRendererImpl::PipelineType::Geometry
+        strokeStyle,
+        transform
     );
 }
 
@@ -291,32 +305,7 @@ void VulkanGraphicsContextImpl::drawEllipse(
     transform
 )
 {
-    std::vector<VulkanPipeline::Vertex> vertices;
-    std::vector<uint16_t> indices;
-
-    StrokeStyle style = strokeStyle;
-    style.start_cap_style = style.dash_cap_style;
-    style.end_cap_style = style.dash_cap_style;
-
-    VulkanTessellator::addArc(
-        Point(0.0f, 0.0f),
-        radiusX,
-        radiusY,
-        0.0f,
-        2.0f * std::numbers::pi,
-        false,
-        style,
-        vertices,
-        indices
-    );
-
-    m_renderer->addCommand(
-        vertices, indices,
-        createFragPushConstantData(pattern),
-        createVertexPushConstantData(transform, center),
-        pattern,
-        VulkanRendererImpl::PipelineType::Geometry
-    );
+    strokeRoundedRect(center, Size{radiusX, radiusY}, radiusX, radiusY, pattern, strokeStyle, transform);
 }
 
 void VulkanGraphicsContextImpl::drawRoundedRect(
@@ -327,181 +316,36 @@ void VulkanGraphicsContextImpl::drawRoundedRect(
     const StrokeStyle& strokeStyle, const Transform2D& transform
 )
 {
-    std::vector<VulkanPipeline::Vertex> vertices;
-    std::vector<uint16_t> indices;
-
-    StrokeStyle style = strokeStyle;
-    style.start_cap_style = style.dash_cap_style;
-    style.end_cap_style = style.dash_cap_style;
-
-    float offset = VulkanTessellator::addArc(
-        Point(-rect.size.width / 2.0f + radiusX, -rect.size.height / 2.0f + radiusY),
-        radiusX,
-        radiusY,
-        std::numbers::pi,
-        0.5f * std::numbers::pi,
-        true,
-        style,
-        vertices,
-        indices
-    );
-    style.dash_offset = offset;
-    offset = VulkanTessellator::addLine(
-        Point(-rect.size.width / 2.0f + radiusX, -rect.size.height / 2.0f),
-        Point(rect.size.width / 2.0f - radiusX, -rect.size.height / 2.0f),
-        style,
-        vertices,
-        indices
-    );
-    style.dash_offset = offset;
-    offset = VulkanTessellator::addArc(
-        Point(rect.size.width / 2.0f - radiusX, -rect.size.height / 2.0f + radiusY),
-        radiusX,
-        radiusY,
-        0.5f * std::numbers::pi,
-        0.0f,
-        true,
-        style,
-        vertices,
-        indices
-    );
-    style.dash_offset = offset;
-    offset = VulkanTessellator::addLine(
-        Point(rect.size.width / 2.0f, -rect.size.height / 2.0f + radiusY),
-        Point(rect.size.width / 2.0f, rect.size.height / 2.0f - radiusY),
-        style,
-        vertices,
-        indices
-    );
-    style.dash_offset = offset;
-    offset = VulkanTessellator::addArc(
-        Point(rect.size.width / 2.0f - radiusX, rect.size.height / 2.0f - radiusY),
+    strokeRoundedRect(
+        Point(rect.pos.x + rect.size.width / 2.0f, rect.pos.y + rect.size.height / 2.0f),
+        Size{rect.size.width / 2.0f, rect.size.height / 2.0f},
         radiusX,
         radiusY,
-        0.0f,
-        1.5f * std::numbers::pi,
-        true,
-        style,
-        vertices,
-        indices
-    );
-    style.dash_offset = offset;
-    offset = VulkanTessellator::addLine(
-        Point(rect.size.width / 2.0f - radiusX, rect.size.height / 2.0f),
-        Point(-rect.size.width / 2.0f + radiusX, rect.size.height / 2.0f),
-        style,
-        vertices,
-        indices
-    );
-    style.dash_offset = offset;
-    offset = VulkanTessellator::addArc(
-        Point(-rect.size.width / 2.0f + radiusX, rect.size.height / 2.0f - radiusY),
-        radiusX,
-        radiusY,
-        1.5f * std::numbers::pi,
-        std::numbers::pi,
-        true,
-        style,
-        vertices,
-        indices
-    );
-    style.dash_offset = offset;
-    VulkanTessellator::addLine(
-        Point(-rect.size.width / 2.0f, rect.size.height / 2.0f - radiusY),
-        Point(-rect.size.width / 2.0f, -rect.size.height / 2.0f + radiusY),
-        style,
-        vertices,
-        indices
-    );
-
-    m_renderer->addCommand(
-        vertices, indices,
-        createFragPushConstantData(pattern),
-        createVertexPushConstantData(transform, Point(
-            rect.pos.x + rect.size.width / 2.0f,
-            rect.pos.y + rect.size.height / 2.0f
-        )),
         pattern,
-        VulkanRendererImpl::PipelineType::Geometry
+        strokeStyle,
+        transform
     );
 }
 
 void VulkanGraphicsContextImpl::fillPath(const PathImpl& path, const Pattern& pattern, const Transform2D& transform)
 {
     std::vector<VulkanPipeline::Vertex> vertices;
-    std::vector<uint16_t> indices;
+    std::vector<uint32_t> indices;
 
-    std::vector<Point> polygonPoints;
-
-    auto commands = path.commands();
-
-    for (const auto& command : commands)
+    auto polygonPoints = flattenPath(path);
+    if (polygonPoints.size() > 1 && polygonPoints.front() == polygonPoints.back())
     {
-        std::visit(
-            [&polygonPoints]<typename T0>(const T0& args)
-            {
-                using T = std::decay_t<T0>;
-                if constexpr (std::is_same_v<T, PathImpl::LineArgs>)
-                {
-                    if (polygonPoints.empty() || polygonPoints.back() != args.end)
-                    {
-                        polygonPoints.push_back(args.end);
-                    }
-                }
-                else if constexpr (std::is_same_v<T, PathImpl::ArcArgs>)
-                {
-                    bool isClockwise = args.isSmallArc
-                                           ? (args.endAngle < args.startAngle)
-                                           : (args.endAngle > args.startAngle);
-
-                    auto arcPoints = VulkanTessellator::splitArc(
-                        args.center,
-                        args.radiusX,
-                        args.radiusY,
-                        args.startAngle,
-                        args.endAngle,
-                        isClockwise
-                    );
-
-                    if (arcPoints.size() < 2)
-                    {
-                        return; // No points to add
-                    }
-
-                    for (int i = 1; i < arcPoints.size(); ++i)
-                    {
-                        if (polygonPoints.empty() || polygonPoints.back() != arcPoints[i])
-                        {
-                            polygonPoints.push_back(arcPoints[i]);
-                        }
-                    }
-                }
-            },
-            command
-        );
+        polygonPoints.pop_back();
     }
 
-    for (auto point : polygonPoints)
-    {
-        vertices.push_back(
-            {
-                .pos = {point.x, point.y},
-                .uv = {-1.0f, -1.0f} // UV coordinates are not used for fill
-            }
-        );
-    }
+    VulkanTessellator::addPolygon(polygonPoints, vertices, indices);
 
-    auto triangles = VulkanTessellator::triangulate(polygonPoints);
-    for (size_t i = 0; i < triangles.size(); i += 3)
-    {
-        indices.push_back(triangles[i]);
-        indices.push_back(triangles[i + 1]);
-        indices.push_back(triangles[i + 2]);
-    }
+    auto fragData = createFragPushConstantData(pattern);
+    fragData.shapeType = static_cast<uint32_t>(ShapeType::Feathered);
 
     m_renderer->addCommand(
         vertices, indices,
-        createFragPushConstantData(pattern),
+        fragData,
         createVertexPushConstantData(transform, Point(0.0f, 0.0f)),
         pattern,
         VulkanRendererImpl::PipelineType::Geometry
@@ -513,66 +357,15 @@ void VulkanGraphicsContextImpl::drawPath(
 )
 {
     std::vector<VulkanPipeline::Vertex> vertices;
-    std::vector<uint16_t> indices;
+    std::vector<uint32_t> indices;
 
-    StrokeStyle style = strokeStyle;
-    style.start_cap_style = style.dash_cap_style;
-    style.end_cap_style = style.dash_cap_style;
-
-    auto commands = path.commands();
-    Point currentPoint = path.startPoint();
-
-    for (const auto& command : commands)
-    {
-        std::visit(
-            [&style, &vertices, &indices, &currentPoint]<typename T0>(const T0& args)
-            {
-                using T = std::decay_t<T0>;
-                if constexpr (std::is_same_v<T, PathImpl::LineArgs>)
-                {
-                    float offset = VulkanTessellator::addLine(
-                        currentPoint,
-                        args.end,
-                        style,
-                        vertices,
-                        indices
-                    );
-
-                    currentPoint = args.end;
-                    style.dash_offset = offset;
-                }
-                else if constexpr (std::is_same_v<T, PathImpl::ArcArgs>)
-                {
-                    bool isClockwise = args.isSmallArc
-                                           ? (args.endAngle < args.startAngle)
-                                           : (args.endAngle > args.startAngle);
-
-                    float offset = VulkanTessellator::addArc(
-                        args.center,
-                        args.radiusX,
-                        args.radiusY,
-                        args.startAngle,
-                        args.endAngle,
-                        isClockwise,
-                        style,
-                        vertices,
-                        indices
-                    );
-                    style.dash_offset = offset;
-
-                    currentPoint = Point(
-                        args.center.x + args.radiusX * std::cos(args.endAngle),
-                        args.center.y + args.radiusY * std::sin(-args.endAngle) // bottom is big
-                    );
-                }
-            },
-            command
-        );
-    }
+    auto points = flattenPath(path);
+    bool isClosed = points.size() > 2 && points.front() == points.back();
+    VulkanTessellator::addPolyline(points, isClosed, strokeStyle, vertices, indices);
 
     m_renderer->addCommand(
         vertices, indices,
-        createFragPushConstantData(pattern),
+        createStrokeFragPushConstantData(pattern, strokeStyle),
         createVertexPushConstantData(transform, Point(0.0f, 0.0f)),
         pattern,
         VulkanRendererImpl::PipelineType::Geometry
@@ -617,7 +410,7 @@ void VulkanGraphicsContextImpl::drawImage(
         }
     };
 
-    std::vector<uint16_t> indices = {
+    std::vector<uint32_t> indices = {
         0, 1, 2, 2, 3, 0
     };
 
@@ -641,4 +434,64 @@ void VulkanGraphicsContextImpl::drawImage(
         VulkanRendererImpl::PipelineType::Geometry
     );
 }
+
+void VulkanGraphicsContextImpl::strokeRoundedRect(
+    Point center,
+    Size halfSize,
+    float radiusX,
+    float radiusY,
+    const Pattern& pattern,
+    const StrokeStyle& strokeStyle,
+    const Transform2D& transform
+)
+{
+    // covers both halves of the stroke. the outline itself is evaluated in the fragment shader
+    float extentX = halfSize.width + strokeStyle.width / 2.0f + VulkanTessellator::ANTIALIAS_WIDTH;
+    float extentY = halfSize.height + strokeStyle.width / 2.0f + VulkanTessellator::ANTIALIAS_WIDTH;
+    auto halfSizeVec = toGlmVec2(halfSize);
+
+    std::vector<VulkanPipeline::Vertex> vertices = {
+        {
+            .pos = {-extentX, -extentY},
+            .uv = halfSizeVec,
+        },
+        {
+            .pos = {extentX, -extentY},
+            .uv = halfSizeVec,
+        },
+        {
+            .pos = {extentX, extentY},
+            .uv = halfSizeVec,
+        },
+        {
+            .pos = {-extentX, extentY},
+            .uv = halfSizeVec,
+        }
+    };
+
+    std::vector<uint32_t> indices = {
+        0, 1, 2, 2, 3, 0
+    };
+
+    auto fragData = createStrokeFragPushConstantData(pattern, strokeStyle);
+    fragData.shapeType = static_cast<uint32_t>(ShapeType::RoundedRectangleStroke);
+    fragData.shapeParams = glm::vec2(
+        std::clamp(radiusX, 0.0f, halfSize.width),
+        std::clamp(radiusY, 0.0f, halfSize.height)
+    );
+    if (std::min(fragData.shapeParams.x, fragData.shapeParams.y) <= 0.0f)
+    {
+        // sharp corners
+        fragData.shapeParams = glm::vec2(0.0f);
+        fragData.joinStyle = static_cast<uint32_t>(rightAngleJoinStyle(strokeStyle));
+    }
+
+    m_renderer->addCommand(
+        vertices, indices,
+        fragData,
+        createVertexPushConstantData(transform, center),
+        pattern,
+        VulkanRendererImpl::PipelineType::Geometry
+    );
+}
 } // karin
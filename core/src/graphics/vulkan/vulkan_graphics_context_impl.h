@@ -8,6 +8,7 @@
 
 #include <karin/common/geometry/point.h>
 #include <karin/common/geometry/rectangle.h>
+#include <karin/common/geometry/size.h>
 #include <karin/graphics/pattern.h>
 #include <karin/graphics/stroke_style.h>
 
@@ -51,10 +52,18 @@ public:
     ) override;
 
 private:
-    VulkanRendererImpl* m_renderer;
+    // one quad per outline. ellipse: radius = half size, rectangle: radius = 0
+    void strokeRoundedRect(
+        Point center,
+        Size halfSize,
+        float radiusX,
+        float radiusY,
+        const Pattern& pattern,
+        const StrokeStyle& strokeStyle,
+        const Transform2D& transform
+    );
 
-    static constexpr int CAP_ROUND_SEGMENTS = 8;
-    static constexpr int ELLIPSE_SEGMENTS = 32;
+    VulkanRendererImpl* m_renderer;
 };
 } // karin
 
@@ -31,12 +31,13 @@ VulkanPipeline::VulkanPipeline(
     const unsigned char* vertShaderCode, unsigned int vertShaderSize,
     const unsigned char* fragShaderCode, unsigned int fragShaderSize,
     const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
-    const std::vector<VkPushConstantRange>& pushConstantRanges
+    const std::vector<VkPushConstantRange>& pushConstantRanges,
+    const VertexInput& vertexInput
 )
 {
     createPipeline(
         renderPass, vertShaderCode, vertShaderSize, fragShaderCode, fragShaderSize, descriptorSetLayouts,
-        pushConstantRanges
+        pushConstantRanges, vertexInput
     );
 }
 
@@ -60,7 +61,8 @@ void VulkanPipeline::createPipeline(
     const unsigned char* vertShaderCode, unsigned int vertShaderSize,
     const unsigned char* fragShaderCode, unsigned int fragShaderSize,
     const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
-    const std::vector<VkPushConstantRange>& pushConstantRanges
+    const std::vector<VkPushConstantRange>& pushConstantRanges,
+    const VertexInput& vertexInput
 )
 {
     auto vertShader = loadShader(VulkanContext::instance().device(), vertShaderCode, vertShaderSize);
@@ -85,15 +87,12 @@ void VulkanPipeline::createPipeline(
         fragShaderStageInfo
     };
 
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
-
     VkPipelineVertexInputStateCreateInfo vertexInputInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
         .vertexBindingDescriptionCount = 1,
-        .pVertexBindingDescriptions = &bindingDescription,
-        .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size()),
-        .pVertexAttributeDescriptions = attributeDescriptions.data()
+        .pVertexBindingDescriptions = &vertexInput.binding,
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInput.attributes.size()),
+        .pVertexAttributeDescriptions = vertexInput.attributes.data()
     };
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly = {
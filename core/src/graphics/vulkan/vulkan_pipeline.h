@@ -4,6 +4,8 @@
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace karin
@@ -11,12 +13,19 @@ namespace karin
 class VulkanPipeline
 {
 public:
+    struct VertexInput
+    {
+        VkVertexInputBindingDescription binding;
+        std::vector<VkVertexInputAttributeDescription> attributes;
+    };
+
     VulkanPipeline(
         VkRenderPass renderPass,
         const unsigned char* vertShaderCode, unsigned int vertShaderSize,
         const unsigned char* fragShaderCode, unsigned int fragShaderSize,
         const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
-        const std::vector<VkPushConstantRange>& pushConstantRanges
+        const std::vector<VkPushConstantRange>& pushConstantRanges,
+        const VertexInput& vertexInput = Vertex::getVertexInput()
     );
     ~VulkanPipeline() = default;
 
@@ -72,7 +81,83 @@ public:
             };
             return attributeDescriptions;
         }
+
+        static VertexInput getVertexInput()
+        {
+            auto attributeDescriptions = getAttributeDescriptions();
+            return {
+                .binding = getBindingDescription(),
+                .attributes = {attributeDescriptions.begin(), attributeDescriptions.end()},
+            };
+        }
+    };
+
+    // one per glyph, expanded to a quad in text.vert. already transformed, so texts with different
+    // transforms and colors share a draw
+    struct GlyphInstance
+    {
+        // top-left corner in window pixels
+        glm::vec2 pos;
+        // edges from the top-left corner along the glyph's x and y axes. pixels, packHalf2x16
+        uint32_t axisX;
+        uint32_t axisY;
+        // atlas rectangle (x, y, width, height). unorm 16
+        std::array<uint16_t, 4> uvRect;
+        // atlas page
+        uint32_t page;
+        // rgba. unorm 8, solid color pattern only
+        std::array<uint8_t, 4> color;
+
+        static VertexInput getVertexInput()
+        {
+            return {
+                .binding = {
+                    .binding = 0,
+                    .stride = sizeof(GlyphInstance),
+                    .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+                },
+                .attributes = {
+                    VkVertexInputAttributeDescription{
+                        .location = 0,
+                        .binding = 0,
+                        .format = VK_FORMAT_R32G32_SFLOAT,
+                        .offset = offsetof(GlyphInstance, pos)
+                    },
+                    VkVertexInputAttributeDescription{
+                        .location = 1,
+                        .binding = 0,
+                        .format = VK_FORMAT_R16G16_SFLOAT,
+                        .offset = offsetof(GlyphInstance, axisX)
+                    },
+                    VkVertexInputAttributeDescription{
+                        .location = 2,
+                        .binding = 0,
+                        .format = VK_FORMAT_R16G16_SFLOAT,
+                        .offset = offsetof(GlyphInstance, axisY)
+                    },
+                    VkVertexInputAttributeDescription{
+                        .location = 3,
+                        .binding = 0,
+                        .format = VK_FORMAT_R16G16B16A16_UNORM,
+                        .offset = offsetof(GlyphInstance, uvRect)
+                    },
+                    VkVertexInputAttributeDescription{
+                        .location = 4,
+                        .binding = 0,
+                        .format = VK_FORMAT_R32_UINT,
+                        .offset = offsetof(GlyphInstance, page)
+                    },
+                    VkVertexInputAttributeDescription{
+                        .location = 5,
+                        .binding = 0,
+                        .format = VK_FORMAT_R8G8B8A8_UNORM,
+                        .offset = offsetof(GlyphInstance, color)
+                    },
+                },
+            };
+        }
     };
+    static_assert(sizeof(GlyphInstance) == 32);
 
 private:
     void createPipeline(
@@ -80,7 +165,8 @@ private:
         const unsigned char* vertShaderCode, unsigned int vertShaderSize,
         const unsigned char* fragShaderCode, unsigned int fragShaderSize,
         const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
-        const std::vector<VkPushConstantRange>& pushConstantRanges
+        const std::vector<VkPushConstantRange>& pushConstantRanges,
+        const VertexInput& vertexInput
     );
 
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
@@ -28,6 +28,7 @@ VulkanRendererImpl::VulkanRendererImpl(
 
     createVertexBuffer();
     createIndexBuffer();
+    createInstanceBuffer();
     createMatrixBuffer();
 
     createPipeline();
@@ -71,6 +72,10 @@ void VulkanRendererImpl::cleanUp()
 
     vmaDestroyBuffer(VulkanContext::instance().allocator(), m_vertexBuffer, m_vertexAllocation);
     vmaDestroyBuffer(VulkanContext::instance().allocator(), m_indexBuffer, m_indexAllocation);
+    for (size_t i = 0; i < m_instanceBuffers.size(); i++)
+    {
+        vmaDestroyBuffer(VulkanContext::instance().allocator(), m_instanceBuffers[i], m_instanceAllocations[i]);
+    }
     for (size_t i = 0; i < m_projMatrixBuffers.size(); ++i)
     {
         vmaDestroyBuffer(VulkanContext::instance().allocator(), m_projMatrixBuffers[i], m_projMatrixBufferAllocations[i]);
@@ -95,6 +100,8 @@ bool VulkanRendererImpl::beginDraw()
     m_indexMapPoint = m_indexStartPoint;
     m_vertexOffset = 0;
     m_indexCount = 0;
+    m_instanceCount = 0;
+    m_lastTextCommand.reset();
     m_drawCommands.clear();
 
     vkWaitForFences(VulkanContext::instance().device(), 1, &m_swapChainFences[m_currentFrame], VK_TRUE, UINT64_MAX);
@@ -118,6 +125,14 @@ bool VulkanRendererImpl::beginDraw()
         throw std::runtime_error("failed to begin command buffer");
     }
 
+    return true;
+}
+
+void VulkanRendererImpl::endDraw()
+{
+    // glyph uploads go before the render pass, in the same command buffer
+    m_fontRenderer->flushGlyphUploads(m_commandBuffers[m_currentFrame], m_currentFrame);
+
     VkRenderPassBeginInfo renderPassInfo = {
         .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
         .renderPass = m_renderPass,
@@ -133,143 +148,76 @@ bool VulkanRendererImpl::beginDraw()
 
     m_surface->setViewPorts(m_commandBuffers[m_currentFrame]);
 
-    return true;
-}
-
-void VulkanRendererImpl::endDraw()
-{
-    m_fontRenderer->flushGlyphUploads();
-
     std::array vertexBuffers = {m_vertexBuffer};
     std::array<VkDeviceSize, 1> offsets = {};
     vkCmdBindVertexBuffers(
         m_commandBuffers[m_currentFrame], 0, vertexBuffers.size(), vertexBuffers.data(), offsets.data()
     );
-    vkCmdBindIndexBuffer(m_commandBuffers[m_currentFrame], m_indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    vkCmdBindIndexBuffer(m_commandBuffers[m_currentFrame], m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-    std::ranges::sort(
-        m_drawCommands,
-        [](const DrawCommand& a, const DrawCommand& b)
-        {
-            return a.pipelineType < b.pipelineType;
-        }
-    );
+    // shapes first, then text over them. commands of a layer keep their call order
+    std::ranges::stable_sort(m_drawCommands, {}, &DrawCommand::layer);
 
-    std::vector<DrawCommand> m_geometryCommands;
-    std::vector<DrawCommand> m_textCommands;
+    VkCommandBuffer commandBuffer = m_commandBuffers[m_currentFrame];
+    std::optional<PipelineType> boundPipeline;
     for (const auto& command : m_drawCommands)
     {
-        switch (command.pipelineType)
-        {
-        case PipelineType::Geometry:
-            m_geometryCommands.push_back(command);
-            break;
-        case PipelineType::Text:
-            m_textCommands.push_back(command);
-            break;
-        }
-    }
-
-    bool isBindProjMatrix = false;
-
-    if (!m_geometryCommands.empty())
-    {
-        vkCmdBindPipeline(
-            m_commandBuffers[m_currentFrame],
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_pipelines[PipelineType::Geometry]->pipeline()
-        );
-
-        auto projectionMatrixDescSet = m_projMatrixDescriptorSets[m_currentFrame];
-        vkCmdBindDescriptorSets(
-            m_commandBuffers[m_currentFrame],
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_pipelines[PipelineType::Geometry]->pipelineLayout(),
-            0, 1, &projectionMatrixDescSet,
-            0, nullptr
-        );
-        isBindProjMatrix = true;
-
-        for (const auto& command : m_geometryCommands)
+        VkPipelineLayout pipelineLayout = m_pipelines[command.pipelineType]->pipelineLayout();
+        if (boundPipeline != command.pipelineType)
         {
-            vkCmdBindDescriptorSets(
-                m_commandBuffers[m_currentFrame],
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                m_pipelines[PipelineType::Geometry]->pipelineLayout(),
-                1, command.descriptorSets.size(), command.descriptorSets.data(),
-                0, nullptr
+            vkCmdBindPipeline(
+                commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[command.pipelineType]->pipeline()
             );
 
-            vkCmdPushConstants(
-                m_commandBuffers[m_currentFrame],
-                m_pipelines[PipelineType::Geometry]->pipelineLayout(),
-                VK_SHADER_STAGE_FRAGMENT_BIT,
-                0, sizeof(FragPushConstants), &command.fragData
-            );
-            vkCmdPushConstants(
-                m_commandBuffers[m_currentFrame],
-                m_pipelines[PipelineType::Geometry]->pipelineLayout(),
-                VK_SHADER_STAGE_VERTEX_BIT,
-                sizeof(FragPushConstants), sizeof(VertexPushConstants), &command.vertData
-            );
-
-            vkCmdDrawIndexed(m_commandBuffers[m_currentFrame], command.indexCount, 1, command.indexOffset, 0, 0);
-        }
-    }
-
-    if (!m_textCommands.empty())
-    {
-        vkCmdBindPipeline(
-            m_commandBuffers[m_currentFrame],
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_pipelines[PipelineType::Text]->pipeline()
-        );
-
-        if (!isBindProjMatrix)
-        {
             auto projectionMatrixDescSet = m_projMatrixDescriptorSets[m_currentFrame];
             vkCmdBindDescriptorSets(
-                m_commandBuffers[m_currentFrame],
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                m_pipelines[PipelineType::Text]->pipelineLayout(),
+                commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
                 0, 1, &projectionMatrixDescSet,
                 0, nullptr
             );
+
+            if (command.pipelineType == PipelineType::Text)
+            {
+                std::array instanceBuffers = {m_instanceBuffers[m_currentFrame]};
+                vkCmdBindVertexBuffers(commandBuffer, 0, instanceBuffers.size(), instanceBuffers.data(), offsets.data());
+
+                auto glyphAtlasSets = m_fontRenderer->glyphAtlasDescriptorSets();
+                vkCmdBindDescriptorSets(
+                    commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
+                    2, 1, &glyphAtlasSets[m_currentFrame],
+                    0, nullptr
+                );
+            }
+            else
+            {
+                vkCmdBindVertexBuffers(commandBuffer, 0, vertexBuffers.size(), vertexBuffers.data(), offsets.data());
+            }
+            boundPipeline = command.pipelineType;
         }
 
-        auto glyphAtlasSets = m_fontRenderer->glyphAtlasDescriptorSets();
         vkCmdBindDescriptorSets(
-            m_commandBuffers[m_currentFrame],
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_pipelines[PipelineType::Text]->pipelineLayout(),
-            2, 1, &glyphAtlasSets[m_currentFrame],
+            commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
+            1, command.descriptorSets.size(), command.descriptorSets.data(),
             0, nullptr
         );
+        vkCmdPushConstants(
+            commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
+            0, sizeof(FragPushConstants), &command.fragData
+        );
 
-        for (const auto& command : m_textCommands)
+        switch (command.pipelineType)
         {
-            vkCmdBindDescriptorSets(
-                m_commandBuffers[m_currentFrame],
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                m_pipelines[PipelineType::Text]->pipelineLayout(),
-                1, command.descriptorSets.size(), command.descriptorSets.data(),
-                0, nullptr
-            );
-
-            vkCmdPushConstants(
-                m_commandBuffers[m_currentFrame],
-                m_pipelines[PipelineType::Text]->pipelineLayout(),
-                VK_SHADER_STAGE_FRAGMENT_BIT,
-                0, sizeof(FragPushConstants), &command.fragData
-            );
+        case PipelineType::Geometry:
             vkCmdPushConstants(
-                m_commandBuffers[m_currentFrame],
-                m_pipelines[PipelineType::Text]->pipelineLayout(),
-                VK_SHADER_STAGE_VERTEX_BIT,
+                commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
                 sizeof(FragPushConstants), sizeof(VertexPushConstants), &command.vertData
             );
-
-            vkCmdDrawIndexed(m_commandBuffers[m_currentFrame], command.indexCount, 1, command.indexOffset, 0, 0);
+            vkCmdDrawIndexed(commandBuffer, command.indexCount, 1, command.indexOffset, 0, 0);
+            break;
+        case PipelineType::Text:
+            // glyph instances are already transformed. no model matrix
+            vkCmdDraw(commandBuffer, 6, command.instanceCount, 0, command.firstInstance);
+            break;
         }
     }
 
@@ -314,26 +262,34 @@ void VulkanRendererImpl::resize(Size size)
 
 void VulkanRendererImpl::addCommand(
     const std::vector<VulkanPipeline::Vertex>& vertices,
-    std::vector<uint16_t>& indices,
+    std::vector<uint32_t>& indices,
     const FragPushConstants& fragData,
     const VertexPushConstants& vertData,
     const Pattern& pattern,
-    PipelineType pipelineType
+    PipelineType pipelineType,
+    DrawLayer layer
 )
 {
+    if (static_cast<size_t>(m_vertexMapPoint - m_vertexStartPoint) + vertices.size() > maxVertices
+        || m_indexCount + indices.size() > maxIndices)
+    {
+        std::cerr << "vertex buffer is full. geometry is dropped" << std::endl;
+        return;
+    }
+
     memcpy(m_vertexMapPoint, vertices.data(), vertices.size() * sizeof(VulkanPipeline::Vertex));
     m_vertexMapPoint += vertices.size();
 
-    for (uint16_t& index : indices)
+    for (uint32_t& index : indices)
     {
         index += m_vertexOffset;
     }
 
-    memcpy(m_indexMapPoint, indices.data(), indices.size() * sizeof(uint16_t));
+    memcpy(m_indexMapPoint, indices.data(), indices.size() * sizeof(uint32_t));
     m_indexMapPoint += indices.size();
     m_indexCount += indices.size();
 
-    m_vertexOffset += static_cast<uint16_t>(vertices.size());
+    m_vertexOffset += static_cast<uint32_t>(vertices.size());
 
     DrawCommand drawCommand = {
         .indexCount = static_cast<uint32_t>(indices.size()),
@@ -341,31 +297,84 @@ void VulkanRendererImpl::addCommand(
         .fragData = fragData,
         .vertData = vertData,
         .pipelineType = pipelineType,
+        .layer = layer,
     };
 
-    std::visit(
-        [this, &drawCommand]<typename T0>(const T0& p)
+    drawCommand.descriptorSets = patternDescriptorSets(pattern);
+    if (layer == DrawLayer::Text)
+    {
+        // later glyphs must not merge into text drawn under this command
+        m_lastTextCommand.reset();
+    }
+
+    m_drawCommands.push_back(drawCommand);
+}
+
+void VulkanRendererImpl::addGlyphCommand(
+    std::span<const VulkanPipeline::GlyphInstance> instances,
+    const FragPushConstants& fragData,
+    const Pattern& pattern
+)
+{
+    if (m_instanceCount + instances.size() > maxGlyphInstances)
+    {
+        std::cerr << "glyph instance buffer is full. text is dropped" << std::endl;
+        return;
+    }
+
+    memcpy(m_instanceStartPoints[m_currentFrame] + m_instanceCount, instances.data(), instances.size_bytes());
+
+    std::vector<VkDescriptorSet> descriptorSets = patternDescriptorSets(pattern);
+    if (m_lastTextCommand)
+    {
+        // instances of one frame are contiguous, so the previous text command ends at m_instanceCount
+        DrawCommand& lastCommand = m_drawCommands[*m_lastTextCommand];
+        if (lastCommand.fragData == fragData && lastCommand.descriptorSets == descriptorSets)
+        {
+            lastCommand.instanceCount += static_cast<uint32_t>(instances.size());
+            m_instanceCount += static_cast<uint32_t>(instances.size());
+            return;
+        }
+    }
+
+    m_lastTextCommand = m_drawCommands.size();
+    m_drawCommands.push_back({
+        .instanceCount = static_cast<uint32_t>(instances.size()),
+        .firstInstance = m_instanceCount,
+        .fragData = fragData,
+        .pipelineType = PipelineType::Text,
+        .layer = DrawLayer::Text,
+        .descriptorSets = std::move(descriptorSets),
+    });
+
+    m_instanceCount += static_cast<uint32_t>(instances.size());
+}
+
+std::vector<VkDescriptorSet> VulkanRendererImpl::patternDescriptorSets(const Pattern& pattern) const
+{
+    return std::visit(
+        [this]<typename T0>(const T0& p) -> std::vector<VkDescriptorSet>
         {
             using T = std::decay_t<T0>;
             if constexpr (std::is_same_v<T, LinearGradientPattern>)
             {
                 auto descriptorSets = m_deviceResources->gradientPointLutDescriptorSet(p.gradientPoints);
-                drawCommand.descriptorSets.push_back(descriptorSets[m_currentFrame]);
+                return {descriptorSets[m_currentFrame]};
             }
             else if constexpr (std::is_same_v<T, RadialGradientPattern>)
             {
                 auto descriptorSets = m_deviceResources->gradientPointLutDescriptorSet(p.gradientPoints);
-                drawCommand.descriptorSets.push_back(descriptorSets[m_currentFrame]);
+                return {descriptorSets[m_currentFrame]};
             }
             else if constexpr (std::is_same_v<T, ImagePattern>)
             {
                 auto descriptorSets = m_deviceResources->textureDescriptorSet(p.image);
-                drawCommand.descriptorSets.push_back(descriptorSets[m_currentFrame]);
+                return {descriptorSets[m_currentFrame]};
             }
             else if constexpr (std::is_same_v<T, SolidColorPattern>)
             {
                 auto descriptorSets = m_deviceResources->dummyTextureDescriptorSet();
-                drawCommand.descriptorSets.push_back(descriptorSets[m_currentFrame]);
+                return {descriptorSets[m_currentFrame]};
             }
             else
             {
@@ -373,8 +382,6 @@ void VulkanRendererImpl::addCommand(
             }
         }, pattern
     );
-
-    m_drawCommands.push_back(drawCommand);
 }
 
 void VulkanRendererImpl::createCommandBuffers()
@@ -474,10 +481,43 @@ void VulkanRendererImpl::createIndexBuffer()
         throw std::runtime_error("failed to create index buffer");
     }
 
-    m_indexMapPoint = static_cast<uint16_t*>(memoryInfo.pMappedData);
+    m_indexMapPoint = static_cast<uint32_t*>(memoryInfo.pMappedData);
     m_indexStartPoint = m_indexMapPoint;
 }
 
+void VulkanRendererImpl::createInstanceBuffer()
+{
+    m_instanceBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    m_instanceAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+    m_instanceStartPoints.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        VmaAllocationCreateInfo allocInfo = {
+            .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            .usage = VMA_MEMORY_USAGE_AUTO,
+        };
+
+        VkBufferCreateInfo bufferInfo = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = maxGlyphInstances * sizeof(VulkanPipeline::GlyphInstance),
+            .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        };
+
+        VmaAllocationInfo memoryInfo;
+        if (vmaCreateBuffer(
+            VulkanContext::instance().allocator(), &bufferInfo, &allocInfo,
+            &m_instanceBuffers[i], &m_instanceAllocations[i], &memoryInfo
+        ) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create glyph instance buffer");
+        }
+
+        m_instanceStartPoints[i] = static_cast<VulkanPipeline::GlyphInstance*>(memoryInfo.pMappedData);
+    }
+}
+
 void VulkanRendererImpl::createMatrixBuffer()
 {
     VkDescriptorSetLayoutBinding projMatrixLayoutBinding = {
@@ -682,9 +722,10 @@ void VulkanRendererImpl::createPipeline()
     };
     m_pipelines[PipelineType::Text] = std::make_unique<VulkanPipeline>(
         m_renderPass,
-        geometry_vert_spv, geometry_vert_spv_len,
+        text_vert_spv, text_vert_spv_len,
         text_frag_spv, text_frag_spv_len,
-        textDescriptorSetLayouts, pushConstantRanges
+        textDescriptorSetLayouts, pushConstantRanges,
+        VulkanPipeline::GlyphInstance::getVertexInput()
     );
 }
 
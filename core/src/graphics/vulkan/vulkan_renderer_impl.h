@@ -16,6 +16,8 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <unordered_map>
 
 namespace karin
@@ -37,6 +39,13 @@ public:
         Text,
     };
 
+    // all shapes are drawn under all text. commands of a layer are drawn in call order
+    enum class DrawLayer
+    {
+        Shapes,
+        Text,
+    };
+
     VulkanRendererImpl(
         Window::NativeHandle nativeHandle
     );
@@ -59,11 +68,19 @@ public:
 
     void addCommand(
         const std::vector<VulkanPipeline::Vertex>& vertices,
-        std::vector<uint16_t>& indices,
+        std::vector<uint32_t>& indices,
         const FragPushConstants& fragData,
         const VertexPushConstants& vertData,
         const Pattern& pattern,
-        PipelineType pipelineType
+        PipelineType pipelineType,
+        DrawLayer layer = DrawLayer::Shapes
+    );
+    // text: one instance per glyph over a unit quad.
+    // merged into the previous text command when the push constants and descriptor sets are the same
+    void addGlyphCommand(
+        std::span<const VulkanPipeline::GlyphInstance> instances,
+        const FragPushConstants& fragData,
+        const Pattern& pattern
     );
 
     void startResizing() override
@@ -96,9 +113,13 @@ private:
     {
         uint32_t indexCount{};
         uint32_t indexOffset{};
+        // text only
+        uint32_t instanceCount{};
+        uint32_t firstInstance{};
         FragPushConstants fragData;
         VertexPushConstants vertData;
         PipelineType pipelineType;
+        DrawLayer layer = DrawLayer::Shapes;
         std::vector<VkDescriptorSet> descriptorSets;
     };
 
@@ -111,6 +132,7 @@ private:
     void createSyncObjects();
     void createVertexBuffer();
     void createIndexBuffer();
+    void createInstanceBuffer();
     void createMatrixBuffer();
     void createRenderPass();
     void createFrameBuffers();
@@ -118,6 +140,8 @@ private:
 
     void doResize();
 
+    std::vector<VkDescriptorSet> patternDescriptorSets(const Pattern& pattern) const;
+
     std::unique_ptr<VulkanSurface> m_surface;
     std::unordered_map<PipelineType, std::unique_ptr<VulkanPipeline>> m_pipelines;
     std::unique_ptr<VulkanDeviceResources> m_deviceResources;
@@ -144,10 +168,17 @@ private:
     VulkanPipeline::Vertex* m_vertexStartPoint = nullptr;
     VkBuffer m_indexBuffer = VK_NULL_HANDLE;
     VmaAllocation m_indexAllocation = VK_NULL_HANDLE;
-    uint16_t* m_indexMapPoint = nullptr;
-    uint16_t* m_indexStartPoint = nullptr;
-    uint16_t m_vertexOffset = 0;
+    uint32_t* m_indexMapPoint = nullptr;
+    uint32_t* m_indexStartPoint = nullptr;
+    uint32_t m_vertexOffset = 0;
     size_t m_indexCount = 0;
+    // one per frame in flight, so that writing a frame's glyphs does not race the GPU reading the previous one
+    std::vector<VkBuffer> m_instanceBuffers;
+    std::vector<VmaAllocation> m_instanceAllocations;
+    std::vector<VulkanPipeline::GlyphInstance*> m_instanceStartPoints;
+    uint32_t m_instanceCount = 0;
+    // index in m_drawCommands. text is drawn after all shapes, so shapes in between do not break a merge
+    std::optional<size_t> m_lastTextCommand;
 
     MatrixBufferObject m_projMatrixData = {};
     VkDescriptorSetLayout m_projMatrixDescriptorSetLayout = VK_NULL_HANDLE;
@@ -156,8 +187,12 @@ private:
     std::vector<VmaAllocation> m_projMatrixBufferAllocations;
     std::vector<VmaAllocationInfo> m_projMatrixBufferMemoryInfos;
 
-    static constexpr VkDeviceSize vertexBufferSize = 1024 * 128; // 2MB
-    static constexpr VkDeviceSize indexBufferSize = 1024 * 512; // 2MB
+    // 32-bit indices, so that a stroke of 100k segments is one command
+    static constexpr size_t maxVertices = 1 << 20;
+    static constexpr size_t maxIndices = 1 << 22;
+    static constexpr VkDeviceSize vertexBufferSize = maxVertices * sizeof(VulkanPipeline::Vertex); // 16MB
+    static constexpr VkDeviceSize indexBufferSize = maxIndices * sizeof(uint32_t); // 16MB
+    static constexpr uint32_t maxGlyphInstances = 1024 * 96; // 2.25MB per frame in flight
 
     static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
 
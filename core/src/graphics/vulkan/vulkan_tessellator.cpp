@@ -2,8 +2,10 @@
 
 #include "glm_geometry.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <limits>
 #include <list>
 #include <numbers>
 
@@ -23,6 +25,13 @@ bool isConvex(const Point& a, const Point& b, const Point& c)
     return det(a, b, c) > 0;
 }
 
+bool isSamePoint(const glm::vec2& a, const glm::vec2& b)
+{
+    constexpr float epsilon = 1e-4f;
+    auto diff = a - b;
+    return std::abs(diff.x) < epsilon && std::abs(diff.y) < epsilon;
+}
+
 bool isPointInTriangle(const Point& p, const Point& a, const Point& b, const Point& c)
 {
     float p_ab = det(a, b, p);
@@ -35,245 +44,276 @@ bool isPointInTriangle(const Point& p, const Point& a, const Point& b, const Poi
 
 namespace karin
 {
-float VulkanTessellator::addLine(
-    Point start,
-    Point end,
+void VulkanTessellator::addPolyline(
+    std::span<const Point> points,
+    bool isClosed,
     const StrokeStyle& strokeStyle,
     std::vector<VulkanPipeline::Vertex>& vertices,
-    std::vector<uint16_t>& indices
+    std::vector<uint32_t>& indices
 )
 {
-    if (start == end)
+    std::vector<glm::vec2> contour;
+    contour.reserve(points.size());
+    for (const auto& point : points)
+    {
+        auto pointVec = toGlmVec2(point);
+        if (contour.empty() || !isSamePoint(contour.back(), pointVec))
+        {
+            contour.push_back(pointVec);
+        }
+    }
+    if (isClosed && contour.size() > 1 && isSamePoint(contour.front(), contour.back()))
     {
-        return strokeStyle.dash_offset;
+        contour.pop_back();
+    }
+    if (contour.size() < 2)
+    {
+        return;
+    }
+    if (contour.size() < 3)
+    {
+        isClosed = false;
     }
 
-    float dashOffset = 0.0f;
-
-    auto startVec = toGlmVec2(start);
-    auto endVec = toGlmVec2(end);
-
-    // 1 unit = 1 width
-    auto dirUnitVec = glm::normalize(toGlmVec2(end - start)) * strokeStyle.width;
-    // 1 unit = 1/2 width
-    auto normalVec = glm::vec2(-dirUnitVec.y, dirUnitVec.x) / 2.0f;
+    size_t count = contour.size();
+    float halfWidth = strokeStyle.width / 2.0f;
+    // geometry is widened by the anti-aliasing margin. the shader fades out past halfWidth
+    float outerHalfWidth = halfWidth + ANTIALIAS_WIDTH;
 
-    std::vector<std::pair<glm::vec2, glm::vec2>> lines;
-    auto current = startVec - dirUnitVec * strokeStyle.dash_offset;
-    if (strokeStyle.dash_pattern.empty())
+    auto direction = [&](size_t i)
     {
-        lines.push_back({startVec, endVec});
-    }
-    else
+        return glm::normalize(contour[(i + 1) % count] - contour[i]);
+    };
+    auto segmentLength = [&](size_t i)
     {
-        auto dashPatternIndex = 0;
-        while (true)
-        {
-            std::pair<glm::vec2, glm::vec2> line;
-            line.first = current;
-            if ((endVec.x - current.x) / dirUnitVec.x < strokeStyle.dash_pattern[dashPatternIndex]
-                || (endVec.y - current.y) / dirUnitVec.y < strokeStyle.dash_pattern[dashPatternIndex])
+        return glm::distance(contour[(i + 1) % count], contour[i]);
+    };
+    auto addEndPair = [&](const glm::vec2& point, const glm::vec2& dir, float arcLength) -> JoinIndices
+    {
+        auto normalVec = glm::vec2(-dir.y, dir.x) * outerHalfWidth;
+        vertices.push_back({.pos = point + normalVec, .uv = {-outerHalfWidth, arcLength}});
+        vertices.push_back({.pos = point - normalVec, .uv = {outerHalfWidth, arcLength}});
+        auto left = static_cast<uint32_t>(vertices.size() - 2);
+        auto right = static_cast<uint32_t>(vertices.size() - 1);
+        return {left, right, left, right};
+    };
+    auto addSegment = [&](const JoinIndices& from, const JoinIndices& to)
+    {
+        indices.insert(
+            indices.end(),
             {
-                line.second = endVec;
-                lines.push_back(line);
-                if (dirUnitVec.x != 0.0f)
-                {
-                    dashOffset = (endVec.x - current.x) / dirUnitVec.x;
-                    for (int i = 0; i < dashPatternIndex; ++i)
-                    {
-                        dashOffset += strokeStyle.dash_pattern[i];
-                    }
-                }
-                else if (dirUnitVec.y != 0.0f)
-                {
-                    dashOffset = (endVec.y - current.y) / dirUnitVec.y;
-                    for (int i = 0; i < dashPatternIndex; ++i)
-                    {
-                        dashOffset += strokeStyle.dash_pattern[i];
-                    }
-                }
-                break;
+                from.outLeft,
+                from.outRight,
+                to.inRight,
+                to.inRight,
+                to.inLeft,
+                from.outLeft
             }
+        );
+    };
 
-            line.second = current + dirUnitVec * strokeStyle.dash_pattern[dashPatternIndex];
-            lines.push_back(line);
+    vertices.reserve(vertices.size() + count * 2);
+    indices.reserve(indices.size() + count * 6);
 
-            current = line.second;
-            dashPatternIndex = (dashPatternIndex + 1) % strokeStyle.dash_pattern.size();
-        }
-    }
+    // dashes are evaluated in the fragment shader from the arc length
+    float arcLength = 0.0f;
 
-    int startIndex = 0;
-    int endIndex = static_cast<int>(lines.size()) - 1;
-    if (endIndex % 2 == 1)
+    JoinIndices first;
+    if (isClosed)
     {
-        endIndex -= 1; // Ensure the last line is not a blank line
-    }
-
-    for (int i = 0; i < lines.size(); ++i)
-    {
-        // blank
-        if (i % 2 == 1)
+        float totalLength = 0.0f;
+        for (size_t i = 0; i < count; ++i)
         {
-            continue;
+            totalLength += segmentLength(i);
         }
 
-        // Skip lines that are before the start point
-        if ((lines[i].second.x - startVec.x) / dirUnitVec.x < 0.0f
-            || (lines[i].second.y - startVec.y) / dirUnitVec.y < 0.0f)
+        // the closing segment ends at the full length, the first one starts at zero
+        first = addJoin(
+            contour[0],
+            direction(count - 1),
+            direction(0),
+            segmentLength(count - 1),
+            segmentLength(0),
+            totalLength,
+            strokeStyle,
+            vertices,
+            indices
+        );
+        for (uint32_t* index : {&first.outLeft, &first.outRight})
         {
-            startIndex = i + 2;
-            continue;
+            auto vertex = vertices[*index];
+            vertex.uv.y = 0.0f;
+            vertices.push_back(vertex);
+            *index = static_cast<uint32_t>(vertices.size() - 1);
         }
+    }
+    else
+    {
+        auto dir = direction(0);
+        first = addEndPair(contour[0], dir, arcLength);
+        addCapStyle(
+            strokeStyle.start_cap_style,
+            vertices,
+            indices,
+            contour[0],
+            -dir,
+            halfWidth,
+            arcLength
+        );
+    }
 
-        // Skip lines that are after the end point
-        if ((lines[i].first.x - endVec.x) / dirUnitVec.x > 0.0f
-            || (lines[i].first.y - endVec.y) / dirUnitVec.y > 0.0f)
-        {
-            endIndex = i - 2;
-            continue;
-        }
+    JoinIndices previous = first;
+    for (size_t i = 1; i < count; ++i)
+    {
+        arcLength += segmentLength(i - 1);
 
-        // Adjust the first point to the start point
-        if ((lines[i].first.x - startVec.x) / dirUnitVec.x < 0.0f
-            || (lines[i].first.y - startVec.y) / dirUnitVec.y < 0.0f)
+        JoinIndices current;
+        if (!isClosed && i == count - 1)
         {
-            lines[i].first = startVec;
+            auto dir = direction(i - 1);
+            current = addEndPair(contour[i], dir, arcLength);
+            addCapStyle(
+                strokeStyle.end_cap_style,
+                vertices,
+                indices,
+                contour[i],
+                dir,
+                halfWidth,
+                arcLength
+            );
         }
-
-        // Skip zero length lines
-        if (lines[i].first == lines[i].second)
+        else
         {
-            continue;
+            current = addJoin(
+                contour[i],
+                direction(i - 1),
+                direction(i),
+                segmentLength(i - 1),
+                segmentLength(i),
+                arcLength,
+                strokeStyle,
+                vertices,
+                indices
+            );
         }
 
-        vertices.insert(
-            vertices.end(),
-            {
-                {
-                    .pos = lines[i].first + normalVec,
-                    .uv = {-1.0f, -1.0f},
-                },
-                {
-                    .pos = lines[i].first - normalVec,
-                    .uv = {1.0f, -1.0f},
-                },
-                {
-                    .pos = lines[i].second - normalVec,
-                    .uv = {1.0f, 1.0f},
-                },
-                {
-                    .pos = lines[i].second + normalVec,
-                    .uv = {-1.0f, 1.0f},
-                }
-            }
-        );
+        addSegment(previous, current);
+        previous = current;
+    }
 
-        auto baseIndex = static_cast<uint16_t>(vertices.size() - 4);
-        indices.insert(
-            indices.end(),
-            {
-                baseIndex,
-                static_cast<uint16_t>(baseIndex + 1),
-                static_cast<uint16_t>(baseIndex + 2),
-                static_cast<uint16_t>(baseIndex + 2),
-                static_cast<uint16_t>(baseIndex + 3),
-                baseIndex
-            }
-        );
+    if (isClosed)
+    {
+        addSegment(previous, first);
     }
+}
+
+VulkanTessellator::JoinIndices VulkanTessellator::addJoin(
+    const glm::vec2& point,
+    const glm::vec2& dirIn,
+    const glm::vec2& dirOut,
+    float lengthIn,
+    float lengthOut,
+    float arcLength,
+    const StrokeStyle& strokeStyle,
+    std::vector<VulkanPipeline::Vertex>& vertices,
+    std::vector<uint32_t>& indices
+)
+{
+    // widened by the anti-aliasing margin like the rest of the stroke
+    float outerHalfWidth = strokeStyle.width / 2.0f + ANTIALIAS_WIDTH;
+    auto normalIn = glm::vec2(-dirIn.y, dirIn.x);
+    auto normalOut = glm::vec2(-dirOut.y, dirOut.x);
+    float cross = dirIn.x * dirOut.y - dirIn.y * dirOut.x;
+
+    // every join vertex lies on an offset edge of both segments: uv = (-+outerHalfWidth, arcLength)
+    auto addVertex = [&](const glm::vec2& pos, float side)
+    {
+        vertices.push_back({.pos = pos, .uv = {-side * outerHalfWidth, arcLength}});
+        return static_cast<uint32_t>(vertices.size() - 1);
+    };
 
-    if (startIndex > endIndex)
+    // (almost) straight: one shared pair
+    if (std::abs(cross) < STRAIGHT_JOIN_EPSILON && glm::dot(dirIn, dirOut) > 0.0f)
     {
-        // No lines to draw
-        return dashOffset;
+        auto left = addVertex(point + normalIn * outerHalfWidth, 1.0f);
+        auto right = addVertex(point - normalIn * outerHalfWidth, -1.0f);
+        return {left, right, left, right};
     }
 
-    addCapStyle(
-        strokeStyle.start_cap_style,
-        vertices,
-        indices,
-        lines[startIndex].first,
-        dirUnitVec,
-        normalVec,
-        strokeStyle.width
-    );
+    // side the path turns away from. cross > 0 turns towards +normal
+    float outer = cross > 0.0f ? -1.0f : 1.0f;
+
+    // miter length / half width = 1 / cos(half of the angle between normals)
+    auto normalSum = normalIn + normalOut;
+    float normalSumLength = glm::length(normalSum);
+    bool isReversal = normalSumLength < STRAIGHT_JOIN_EPSILON;
+    float miterRatio = isReversal ? std::numeric_limits<float>::infinity() : 2.0f / normalSumLength;
+    auto miterDir = isReversal ? glm::vec2(0.0f, 0.0f) : normalSum / normalSumLength;
 
-    addCapStyle(
-        strokeStyle.end_cap_style,
-        vertices,
-        indices,
-        lines[endIndex].second,
-        -dirUnitVec,
-        normalVec,
-        strokeStyle.width
+    // inner corner is where the offset edges cross. clamp it so that short segments do not spike
+    float innerLength = std::min(
+        outerHalfWidth * miterRatio,
+        std::sqrt(outerHalfWidth * outerHalfWidth + std::min(lengthIn, lengthOut) * std::min(lengthIn, lengthOut))
     );
+    auto inner = addVertex(point - miterDir * (outer * innerLength), -outer);
 
-    for (int i = startIndex + 2; i <= endIndex; i += 2)
+    auto toJoinIndices = [&](uint32_t outerIn, uint32_t outerOut) -> JoinIndices
     {
-        addCapStyle(
-            strokeStyle.dash_cap_style,
-            vertices,
-            indices,
-            lines[i - 2].second,
-            -dirUnitVec,
-            normalVec,
-            strokeStyle.width
-        );
-        addCapStyle(
-            strokeStyle.dash_cap_style,
-            vertices,
-            indices,
-            lines[i].first,
-            dirUnitVec,
-            normalVec,
-            strokeStyle.width
-        );
-    }
-
-    return dashOffset;
-}
+        if (outer > 0.0f)
+        {
+            return {outerIn, inner, outerOut, inner};
+        }
+        return {inner, outerIn, inner, outerOut};
+    };
 
-float VulkanTessellator::addArc(
-    Point center,
-    float radiusX,
-    float radiusY,
-    float startAngle,
-    float endAngle,
-    bool isClockwise,
-    const StrokeStyle& strokeStyle,
-    std::vector<VulkanPipeline::Vertex>& vertices,
-    std::vector<uint16_t>& indices
-)
-{
-    StrokeStyle style = strokeStyle;
+    if (strokeStyle.join_style == StrokeStyle::JoinStyle::Miter && miterRatio <= strokeStyle.miter_limit)
+    {
+        auto miter = addVertex(point + miterDir * (outer * outerHalfWidth * miterRatio), outer);
+        return toJoinIndices(miter, miter);
+    }
 
-    auto arcPoints = splitArc(center, radiusX, radiusY, startAngle, endAngle, isClockwise);
-    for (size_t i = 0; i < arcPoints.size() - 1; ++i)
+    // bevel, or miter over the limit
+    auto outerIn = addVertex(point + normalIn * (outer * outerHalfWidth), outer);
+    auto previous = outerIn;
+    if (strokeStyle.join_style == StrokeStyle::JoinStyle::Round)
     {
-        float dashOffset = addLine(
-            arcPoints[i],
-            arcPoints[i + 1],
-            style,
-            vertices,
-            indices
-        );
-        style.dash_offset = dashOffset;
+        auto from = normalIn * outer;
+        auto to = normalOut * outer;
+        float startAngle = std::atan2(from.y, from.x);
+        float sweep = std::atan2(from.x * to.y - from.y * to.x, glm::dot(from, to));
+        constexpr float angleStep = std::numbers::pi / CAP_ROUND_SEGMENTS;
+        int segments = std::max(1, static_cast<int>(std::ceil(std::abs(sweep) / angleStep)));
+
+        for (int i = 1; i < segments; ++i)
+        {
+            float angle = startAngle + sweep * static_cast<float>(i) / static_cast<float>(segments);
+            auto current = addVertex(point + glm::vec2(std::cos(angle), std::sin(angle)) * outerHalfWidth, outer);
+            indices.insert(indices.end(), {inner, previous, current});
+            previous = current;
+        }
     }
+    auto outerOut = addVertex(point + normalOut * (outer * outerHalfWidth), outer);
+    indices.insert(indices.end(), {inner, previous, outerOut});
 
-    return style.dash_offset;
+    return toJoinIndices(outerIn, outerOut);
 }
 
 void VulkanTessellator::addCapStyle(
     const StrokeStyle::CapStyle capStyle,
     std::vector<VulkanPipeline::Vertex>& vertices,
-    std::vector<uint16_t>& indices,
+    std::vector<uint32_t>& indices,
     const glm::vec2& centerVec,
-    const glm::vec2& dirUnitVec,
-    const glm::vec2& normalVec,
-    const float width
+    const glm::vec2& outwardVec,
+    const float halfWidth,
+    const float arcLength
 )
 {
+    // sides are widened by the anti-aliasing margin like the stroke itself
+    // cap vertices keep the arc length of the end point, so a cap is drawn whenever its dash covers the end
+    float outerHalfWidth = halfWidth + ANTIALIAS_WIDTH;
+    auto normalVec = glm::vec2(-outwardVec.y, outwardVec.x) * outerHalfWidth;
+    auto baseIndex = static_cast<uint32_t>(vertices.size());
+
     switch (capStyle)
     {
     case StrokeStyle::CapStyle::Butt:
@@ -281,40 +321,36 @@ void VulkanTessellator::addCapStyle(
 
     case StrokeStyle::CapStyle::Round:
     {
-        float baseAngle = std::atan2(-dirUnitVec.y, -dirUnitVec.x);
+        // uv.x is the distance from the center, so the rim is anti-aliased like the sides
+        float baseAngle = std::atan2(outwardVec.y, outwardVec.x);
         float startAngle = baseAngle - std::numbers::pi / 2.0f;
-        float endAngle = baseAngle + std::numbers::pi / 2.0f;
-        float angleStep = (endAngle - startAngle) / CAP_ROUND_SEGMENTS;
-        float radius = width / 2.0f;
+        float angleStep = std::numbers::pi / CAP_ROUND_SEGMENTS;
 
         for (int i = 0; i <= CAP_ROUND_SEGMENTS; ++i)
         {
             float angle = startAngle + i * angleStep;
-            auto pos = centerVec + glm::vec2(std::cos(angle), std::sin(angle)) * radius;
-
             vertices.push_back(
                 {
-                    .pos = pos,
-                    .uv = {-1.0f, -1.0f},
+                    .pos = centerVec + glm::vec2(std::cos(angle), std::sin(angle)) * outerHalfWidth,
+                    .uv = {outerHalfWidth, arcLength},
                 }
             );
         }
         vertices.push_back(
             {
                 .pos = centerVec,
-                .uv = {0.0f, 0.0f},
+                .uv = {0.0f, arcLength},
             }
         );
 
-        auto baseIndex = static_cast<uint16_t>(vertices.size() - CAP_ROUND_SEGMENTS - 2);
         for (int i = 0; i < CAP_ROUND_SEGMENTS; ++i)
         {
             indices.insert(
                 indices.end(),
                 {
-                    static_cast<uint16_t>(baseIndex + i),
-                    static_cast<uint16_t>(baseIndex + i + 1),
-                    static_cast<uint16_t>(baseIndex + CAP_ROUND_SEGMENTS + 1)
+                    static_cast<uint32_t>(baseIndex + i),
+                    static_cast<uint32_t>(baseIndex + i + 1),
+                    static_cast<uint32_t>(baseIndex + CAP_ROUND_SEGMENTS + 1)
                 }
             );
         }
@@ -323,36 +359,36 @@ void VulkanTessellator::addCapStyle(
 
     case StrokeStyle::CapStyle::Square:
     {
+        auto extentVec = outwardVec * halfWidth;
         vertices.insert(
             vertices.end(),
             {
                 {
-                    .pos = centerVec - dirUnitVec + normalVec,
-                    .uv = {-1.0f, -1.0f},
+                    .pos = centerVec + normalVec,
+                    .uv = {-outerHalfWidth, arcLength},
                 },
                 {
-                    .pos = centerVec - dirUnitVec - normalVec,
-                    .uv = {1.0f, -1.0f},
+                    .pos = centerVec - normalVec,
+                    .uv = {outerHalfWidth, arcLength},
                 },
                 {
-                    .pos = centerVec + normalVec,
-                    .uv = {1.0f, 1.0f},
+                    .pos = centerVec + extentVec - normalVec,
+                    .uv = {outerHalfWidth, arcLength},
                 },
                 {
-                    .pos = centerVec - normalVec,
-                    .uv = {-1.0f, 1.0f},
+                    .pos = centerVec + extentVec + normalVec,
+                    .uv = {-outerHalfWidth, arcLength},
                 }
             }
         );
-        auto baseIndex = static_cast<uint16_t>(vertices.size() - 4);
         indices.insert(
             indices.end(),
             {
                 baseIndex,
-                static_cast<uint16_t>(baseIndex + 1),
-                static_cast<uint16_t>(baseIndex + 2),
-                static_cast<uint16_t>(baseIndex + 2),
-                static_cast<uint16_t>(baseIndex + 3),
+                static_cast<uint32_t>(baseIndex + 1),
+                static_cast<uint32_t>(baseIndex + 2),
+                static_cast<uint32_t>(baseIndex + 2),
+                static_cast<uint32_t>(baseIndex + 3),
                 baseIndex
             }
         );
@@ -366,26 +402,24 @@ void VulkanTessellator::addCapStyle(
             {
                 {
                     .pos = centerVec + normalVec,
-                    .uv = {-1.0f, -1.0f},
+                    .uv = {-outerHalfWidth, arcLength},
                 },
                 {
                     .pos = centerVec - normalVec,
-                    .uv = {1.0f, -1.0f},
+                    .uv = {outerHalfWidth, arcLength},
                 },
                 {
-                    .pos = centerVec - dirUnitVec / 2.0f,
-                    .uv = {1.0f, 1.0f},
+                    .pos = centerVec + outwardVec * halfWidth,
+                    .uv = {0.0f, arcLength},
                 },
             }
         );
-
-        auto baseIndex = static_cast<uint16_t>(vertices.size() - 3);
         indices.insert(
             indices.end(),
             {
                 baseIndex,
-                static_cast<uint16_t>(baseIndex + 1),
-                static_cast<uint16_t>(baseIndex + 2),
+                static_cast<uint32_t>(baseIndex + 1),
+                static_cast<uint32_t>(baseIndex + 2),
             }
         );
     }
@@ -443,9 +477,89 @@ std::vector<Point> VulkanTessellator::splitArc(
     return points;
 }
 
-std::vector<uint16_t> VulkanTessellator::triangulate(const std::vector<Point>& polygon)
+void VulkanTessellator::addPolygon(
+    std::span<const Point> polygon,
+    std::vector<VulkanPipeline::Vertex>& vertices,
+    std::vector<uint32_t>& indices
+)
+{
+    if (polygon.size() < 3)
+    {
+        return;
+    }
+
+    size_t count = polygon.size();
+    auto baseIndex = static_cast<uint32_t>(vertices.size());
+
+    float signedArea = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        signedArea += det({0, 0}, polygon[i], polygon[(i + 1) % count]);
+    }
+    // +normal of an edge points inside when the area is negative
+    float outward = signedArea < 0.0f ? -1.0f : 1.0f;
+
+    auto edgeNormal = [&](size_t from, size_t to)
+    {
+        auto dir = toGlmVec2(polygon[to] - polygon[from]);
+        float length = glm::length(dir);
+        return length > 0.0f ? glm::vec2(-dir.y, dir.x) / length : glm::vec2(0.0f, 0.0f);
+    };
+
+    // the edge is feathered over ANTIALIAS_WIDTH centered on the outline. uv.x: coverage
+    vertices.reserve(vertices.size() + count * 2);
+    std::vector<glm::vec2> offsets(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto normalIn = edgeNormal((i + count - 1) % count, i);
+        auto normalOut = edgeNormal(i, (i + 1) % count);
+        auto normalSum = normalIn + normalOut;
+        float normalSumLength = glm::length(normalSum);
+        if (normalSumLength > 0.0f)
+        {
+            auto miterDir = normalSum / normalSumLength;
+            float miterRatio = std::min(2.0f / normalSumLength, MAX_FEATHER_MITER_RATIO);
+            offsets[i] = miterDir * (outward * miterRatio * ANTIALIAS_WIDTH / 2.0f);
+        }
+
+        vertices.push_back(
+            {
+                .pos = toGlmVec2(polygon[i]) - offsets[i],
+                .uv = {1.0f, 0.0f},
+            }
+        );
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        vertices.push_back(
+            {
+                .pos = toGlmVec2(polygon[i]) + offsets[i],
+                .uv = {0.0f, 0.0f},
+            }
+        );
+    }
+
+    auto triangles = triangulate(std::vector(polygon.begin(), polygon.end()));
+    indices.reserve(indices.size() + triangles.size() + count * 6);
+    for (auto index : triangles)
+    {
+        indices.push_back(static_cast<uint32_t>(baseIndex + index));
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t next = (i + 1) % count;
+        auto inner = static_cast<uint32_t>(baseIndex + i);
+        auto innerNext = static_cast<uint32_t>(baseIndex + next);
+        auto outer = static_cast<uint32_t>(baseIndex + count + i);
+        auto outerNext = static_cast<uint32_t>(baseIndex + count + next);
+        indices.insert(indices.end(), {inner, outer, outerNext, outerNext, innerNext, inner});
+    }
+}
+
+std::vector<uint32_t> VulkanTessellator::triangulate(const std::vector<Point>& polygon)
 {
-    std::vector<uint16_t> triangleIndices;
+    std::vector<uint32_t> triangleIndices;
 
     if (polygon.size() < 3)
     {
@@ -458,7 +572,7 @@ std::vector<uint16_t> VulkanTessellator::triangulate(const std::vector<Point>& p
         return triangleIndices;
     }
 
-    std::list<uint16_t> indices;
+    std::list<uint32_t> indices;
     for (int i = 0; i < polygon.size(); i++)
     {
         indices.push_back(i);
@@ -484,9 +598,9 @@ std::vector<uint16_t> VulkanTessellator::triangulate(const std::vector<Point>& p
             int curr = i;
             int next = (i + 1) % indices.size();
 
-            uint16_t i_prev = *std::next(indices.begin(), prev);
-            uint16_t i_curr = *std::next(indices.begin(), curr);
-            uint16_t i_next = *std::next(indices.begin(), next);
+            uint32_t i_prev = *std::next(indices.begin(), prev);
+            uint32_t i_curr = *std::next(indices.begin(), curr);
+            uint32_t i_next = *std::next(indices.begin(), next);
 
             const Point& p_p = polygon[i_prev];
             const Point& p_c = polygon[i_curr];
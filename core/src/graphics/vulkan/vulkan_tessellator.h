@@ -9,6 +9,7 @@
 
 #include <glm/glm.hpp>
 
+#include <span>
 #include <vector>
 
 namespace karin
@@ -16,26 +17,25 @@ namespace karin
 class VulkanTessellator
 {
 public:
-    // return dash_offset for next line
-    // point: not normalized (in pixels)
-    static float addLine(
-        Point start,
-        Point end,
+    // width of the coverage ramp at shape edges (in pixels)
+    static constexpr float ANTIALIAS_WIDTH = 1.0f;
+
+    // stroke one contour. segments share their vertices and are connected by strokeStyle.join_style
+    // uv = (offset from the center line, arc length), in pixels. dashes are left to the shader
+    // points: not normalized (in pixels)
+    static void addPolyline(
+        std::span<const Point> points,
+        bool isClosed,
         const StrokeStyle& strokeStyle,
         std::vector<VulkanPipeline::Vertex>& vertices,
-        std::vector<uint16_t>& indices
+        std::vector<uint32_t>& indices
     );
 
-    static float addArc(
-        Point center,
-        float radiusX,
-        float radiusY,
-        float startAngle,
-        float endAngle,
-        bool isClockwise,
-        const StrokeStyle& strokeStyle,
+    // triangulated fill with an anti-aliased (feathered) outline. uv.x: coverage
+    static void addPolygon(
+        std::span<const Point> polygon,
         std::vector<VulkanPipeline::Vertex>& vertices,
-        std::vector<uint16_t>& indices
+        std::vector<uint32_t>& indices
     );
 
     // clockwise: start < end
@@ -48,21 +48,44 @@ public:
         bool isClockwise
     );
 
-    static std::vector<uint16_t> triangulate(const std::vector<Point>& polygon);
+    static std::vector<uint32_t> triangulate(const std::vector<Point>& polygon);
 
 private:
+    // left: +normal side, right: -normal side
+    struct JoinIndices
+    {
+        uint32_t inLeft;
+        uint32_t inRight;
+        uint32_t outLeft;
+        uint32_t outRight;
+    };
+
+    static JoinIndices addJoin(
+        const glm::vec2& point,
+        const glm::vec2& dirIn,
+        const glm::vec2& dirOut,
+        float lengthIn,
+        float lengthOut,
+        float arcLength,
+        const StrokeStyle& strokeStyle,
+        std::vector<VulkanPipeline::Vertex>& vertices,
+        std::vector<uint32_t>& indices
+    );
+
     static void addCapStyle(
         StrokeStyle::CapStyle capStyle,
         std::vector<VulkanPipeline::Vertex>& vertices,
-        std::vector<uint16_t>& indices,
+        std::vector<uint32_t>& indices,
         const glm::vec2& centerVec,
-        const glm::vec2& dirUnitVec,
-        const glm::vec2& normalVec,
-        float width
+        const glm::vec2& outwardVec,
+        float halfWidth,
+        float arcLength
     );
 
     static constexpr int CAP_ROUND_SEGMENTS = 8;
     static constexpr int ELLIPSE_SEGMENTS = 32;
+    static constexpr float STRAIGHT_JOIN_EPSILON = 1e-4f;
+    static constexpr float MAX_FEATHER_MITER_RATIO = 4.0f;
 };
 } // karin
 
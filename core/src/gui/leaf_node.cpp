@@ -6,6 +6,7 @@ namespace karin::gui
 {
 LeafNode::LeafNode()
 {
+    YGNodeSetContext(m_yogaNode, this);
     YGNodeSetMeasureFunc(m_yogaNode, reinterpret_cast<YGMeasureFunc>(staticMeasureFunc));
 }
 
@@ -12,23 +12,73 @@ TextNode::TextNode(std::string text, TextStyle textStyle, ParagraphStyle paragra
 {
 }
 
+void TextNode::setText(std::string text)
+{
+    if (text == m_text)
+    {
+        return;
+    }
+
+    m_text = std::move(text);
+    invalidateLayout();
+}
+
+void TextNode::setTextStyle(TextStyle textStyle)
+{
+    m_textStyle = std::move(textStyle);
+    invalidateLayout();
+}
+
+void TextNode::setParagraphStyle(ParagraphStyle paragraphStyle)
+{
+    m_paragraphStyle = paragraphStyle;
+    invalidateLayout();
+}
+
+void TextNode::setPattern(Pattern pattern)
+{
+    // only changes how the glyphs are painted
+    m_pattern = std::move(pattern);
+}
+
 void TextNode::drawInternal(GraphicsContext& gc, const Transform2D& parentTransform) const
 {
     Rectangle layout = getLayout();
     Point start = layout.pos;
 
-    auto& textEngine = getAppContext().textEngine;
-    auto textBlob = textEngine->layoutText(m_text, m_textStyle, m_paragraphStyle, layout.size);
+    if (!m_textBlob || m_textBlobMaxSize != layout.size)
+    {
+        auto& textEngine = getAppContext().textEngine;
+        m_textBlob = textEngine->layoutText(m_text, m_textStyle, m_paragraphStyle, layout.size);
+        m_textBlobMaxSize = layout.size;
+    }
 
-    gc.drawText(textBlob, start, m_pattern, parentTransform);
+    gc.drawText(*m_textBlob, start, m_pattern, parentTransform);
 }
 
 YGSize TextNode::measure(Size availableSize) const
 {
+    if (auto it = m_measurements.find(availableSize.width); it != m_measurements.end())
+    {
+        return YGSize{it->second.width, it->second.height};
+    }
+
     auto& textEngine = getAppContext().textEngine;
-    auto textBlob = textEngine->layoutText(m_text, m_textStyle, m_paragraphStyle, availableSize);
+    Size measuredSize = textEngine->measureText(m_text, m_textStyle, m_paragraphStyle, availableSize);
 
-    Size measuredSize = textBlob.layoutSize;
+    if (m_measurements.size() >= MAX_CACHED_MEASUREMENTS)
+    {
+        m_measurements.clear();
+    }
+
+    m_measurements[availableSize.width] = measuredSize;
     return YGSize{measuredSize.width, measuredSize.height};
 }
-} // karin::gui
\ No newline at end of file
+
+void TextNode::invalidateLayout()
+{
+    m_textBlob.reset();
+    m_measurements.clear();
+    YGNodeMarkDirty(m_yogaNode);
+}
+} // karin::gui
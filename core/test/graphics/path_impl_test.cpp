@@ -0,0 +1,153 @@
+#include <karin/graphics/path.h>
+#include <path_impl.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace karin;
+
+class PathImplTest : public testing::Test
+{
+protected:
+    PathImpl path;
+};
+
+TEST_F(PathImplTest, lineCommands)
+{
+    path.start(Point(0, 0));
+    path.lineTo(Point(10, 0));
+    path.lineTo(Point(10, 10));
+
+    auto commands = path.commands();
+    ASSERT_EQ(commands.size(), 2);
+    ASSERT_EQ(path.points().size(), 2);
+
+    auto it = commands.begin();
+    ASSERT_TRUE((*it).isLine());
+    ASSERT_EQ((*it).line().end, Point(10, 0));
+    ++it;
+    ASSERT_EQ((*it).line().end, Point(10, 10));
+    ++it;
+    ASSERT_EQ(it, commands.end());
+}
+
+TEST_F(PathImplTest, arcCommand)
+{
+    path.start(Point(0, 0));
+    path.lineTo(Point(5, 0));
+    path.arcTo(Point(5, 5), 5.0f, 3.0f, 1.0f, 2.0f, true);
+    path.arcTo(Point(1, 2), 4.0f, 4.0f, 0.5f, 0.0f, false);
+    path.lineTo(Point(0, 0));
+
+    ASSERT_EQ(path.commands().size(), 4);
+    ASSERT_EQ(path.points().size(), 1 + 3 + 3 + 1);
+
+    std::vector<PathImpl::Command> commands(path.commands().begin(), path.commands().end());
+
+    ASSERT_TRUE(commands[0].isLine());
+    ASSERT_FALSE(commands[1].isLine());
+
+    auto arc = commands[1].arc();
+    ASSERT_EQ(arc.center, Point(5, 5));
+    ASSERT_EQ(arc.radiusX, 5.0f);
+    ASSERT_EQ(arc.radiusY, 3.0f);
+    ASSERT_EQ(arc.startAngle, 1.0f);
+    ASSERT_EQ(arc.endAngle, 2.0f);
+    ASSERT_TRUE(arc.isSmallArc);
+
+    arc = commands[2].arc();
+    ASSERT_EQ(arc.center, Point(1, 2));
+    ASSERT_FALSE(arc.isSmallArc);
+
+    ASSERT_EQ(commands[3].line().end, Point(0, 0));
+}
+
+TEST_F(PathImplTest, addPolyline)
+{
+    std::vector<Point> points = {{1, 1}, {2, 2}, {3, 3}};
+
+    path.start(Point(0, 0));
+    path.addPolyline(points);
+    path.close();
+
+    ASSERT_EQ(path.commands().size(), 4);
+
+    size_t i = 0;
+    for (const auto& command : path.commands())
+    {
+        ASSERT_TRUE(command.isLine());
+        if (i < points.size())
+        {
+            ASSERT_EQ(command.line().end, points[i]);
+        }
+        else
+        {
+            ASSERT_EQ(command.line().end, Point(0, 0));
+        }
+        ++i;
+    }
+}
+
+TEST_F(PathImplTest, startKeepsCapacity)
+{
+    path.reserve(128, 128);
+    path.start(Point(0, 0));
+    path.lineTo(Point(1, 1));
+
+    const Point* data = path.points().data();
+    path.start(Point(0, 0));
+    ASSERT_TRUE(path.commands().empty());
+
+    path.lineTo(Point(2, 2));
+    ASSERT_EQ(path.points().data(), data);
+}
+
+namespace karin
+{
+class PathTest : public testing::Test
+{
+protected:
+    static const PathImpl* impl(const Path& path)
+    {
+        return path.impl();
+    }
+};
+} // karin
+
+TEST_F(PathTest, moveConstruct)
+{
+    Path path;
+    path.start(Point(0, 0));
+    path.lineTo(Point(1, 1));
+    const PathImpl* pathImpl = impl(path);
+
+    Path moved(std::move(path));
+    moved.lineTo(Point(2, 2));
+
+    // the segments move with the storage. the moved-from path keeps none
+    EXPECT_EQ(impl(path), nullptr);
+    ASSERT_EQ(impl(moved), pathImpl);
+    EXPECT_EQ(impl(moved)->verbs().size(), 2);
+    ASSERT_EQ(impl(moved)->points().size(), 2);
+    EXPECT_EQ(impl(moved)->points()[0], Point(1, 1));
+    EXPECT_EQ(impl(moved)->points()[1], Point(2, 2));
+}
+
+TEST_F(PathTest, moveAssign)
+{
+    Path path;
+    path.start(Point(0, 0));
+    path.lineTo(Point(1, 1));
+
+    Path assigned;
+    assigned.start(Point(5, 5));
+    assigned = std::move(path);
+    assigned.close();
+
+    EXPECT_EQ(impl(path), nullptr);
+    ASSERT_NE(impl(assigned), nullptr);
+    EXPECT_EQ(impl(assigned)->startPoint(), Point(0, 0));
+    ASSERT_EQ(impl(assigned)->points().size(), 2);
+    EXPECT_EQ(impl(assigned)->points()[1], Point(0, 0));
+}
@@ -0,0 +1,198 @@
+#include <text/font_loader.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace karin;
+
+namespace
+{
+class FakeFontFace : public IFontFace
+{
+public:
+    FontMetrics getFontMetrics() const override
+    {
+        return {};
+    }
+
+    GlyphMetrics getGlyphMetrics(uint32_t glyphIndex) const override
+    {
+        return {.glyphIndex = glyphIndex};
+    }
+};
+
+struct LoaderCalls
+{
+    int find = 0;
+    int loadFont = 0;
+    int loadFile = 0;
+    int fallback = 0;
+};
+
+// "Regular" and "Alias" live in the same file. "ByName" has no file.
+// the fallbacks of every font: "latin.ttf" covers A-Z, "cjk.ttf" covers A-Z and U+3042
+class FakePlatformFontLoader : public IPlatformFontLoader
+{
+public:
+    explicit FakePlatformFontLoader(LoaderCalls& calls)
+        : m_calls(calls)
+    {
+    }
+
+    std::unique_ptr<IFontFace> loadFont(const Font& font) override
+    {
+        ++m_calls.loadFont;
+        if (font.family != "ByName")
+        {
+            return {};
+        }
+        return std::make_unique<FakeFontFace>();
+    }
+
+    std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath, uint32_t faceIndex) override
+    {
+        ++m_calls.loadFile;
+        if (filePath != "regular.ttf" && filePath != "latin.ttf" && filePath != "cjk.ttf")
+        {
+            return {};
+        }
+        return std::make_unique<FakeFontFace>();
+    }
+
+    std::vector<Font> getFontLists() override
+    {
+        return {};
+    }
+
+    std::optional<FontFileLocation> findFontFile(const Font& font) override
+    {
+        ++m_calls.find;
+        if (font.family == "Regular" || font.family == "Alias")
+        {
+            return FontFileLocation{.filePath = "regular.ttf"};
+        }
+        if (font.family == "Missing")
+        {
+            return FontFileLocation{.filePath = "missing.ttf"};
+        }
+        return std::nullopt;
+    }
+
+    std::vector<FallbackFont> findFallbackFonts(const Font& /*font*/) override
+    {
+        ++m_calls.fallback;
+        auto latin = std::make_shared<FontCoverage>();
+        auto cjk = std::make_shared<FontCoverage>();
+        for (char32_t c = U'A'; c <= U'Z'; ++c)
+        {
+            latin->add(c);
+            cjk->add(c);
+        }
+        cjk->add(U'\u3042');
+
+        return {
+            {.location = {.filePath = "latin.ttf"}, .coverage = latin},
+            {.location = {.filePath = "cjk.ttf"}, .coverage = cjk},
+        };
+    }
+
+private:
+    LoaderCalls& m_calls;
+};
+}
+
+class FontLoaderTest : public testing::Test
+{
+protected:
+    LoaderCalls calls;
+    FontLoader loader{std::make_unique<FakePlatformFontLoader>(calls)};
+};
+
+TEST_F(FontLoaderTest, cachedFontDoesNotReachPlatform)
+{
+    auto face1 = loader.loadFont(Font{.family = "Regular"});
+    auto face2 = loader.loadFont(Font{.family = "Regular"});
+
+    ASSERT_NE(face1, nullptr);
+    EXPECT_EQ(face1, face2);
+    EXPECT_EQ(calls.find, 1);
+    EXPECT_EQ(calls.loadFile, 1);
+}
+
+TEST_F(FontLoaderTest, fontsInSameFileShareFace)
+{
+    auto regular = loader.loadFont(Font{.family = "Regular"});
+    auto alias = loader.loadFont(Font{.family = "Alias"});
+    auto fromFile = loader.loadFontFromFile("regular.ttf");
+
+    EXPECT_EQ(regular, alias);
+    EXPECT_EQ(regular, fromFile);
+    EXPECT_EQ(calls.loadFile, 1);
+}
+
+TEST_F(FontLoaderTest, eachStyleIsResolvedOnce)
+{
+    auto normal = loader.loadFont(Font{.family = "Regular"});
+    auto bold = loader.loadFont(Font{.family = "Regular", .weight = Font::Weight::BOLD});
+
+    EXPECT_EQ(normal, bold);
+    EXPECT_EQ(calls.find, 2);
+}
+
+TEST_F(FontLoaderTest, fallsBackToPlatformLoadFont)
+{
+    auto face1 = loader.loadFont(Font{.family = "ByName"});
+    auto face2 = loader.loadFont(Font{.family = "ByName"});
+
+    ASSERT_NE(face1, nullptr);
+    EXPECT_EQ(face1, face2);
+    EXPECT_EQ(calls.loadFont, 1);
+    EXPECT_EQ(calls.loadFile, 0);
+}
+
+TEST_F(FontLoaderTest, failedLookupIsCached)
+{
+    EXPECT_EQ(loader.loadFont(Font{.family = "Missing"}), nullptr);
+    EXPECT_EQ(loader.loadFont(Font{.family = "Missing"}), nullptr);
+    EXPECT_EQ(calls.find, 1);
+    EXPECT_EQ(calls.loadFile, 1);
+}
+
+TEST_F(FontLoaderTest, clearCacheReloads)
+{
+    auto face1 = loader.loadFont(Font{.family = "Regular"});
+    loader.clearCache();
+    auto face2 = loader.loadFont(Font{.family = "Regular"});
+
+    EXPECT_NE(face1, face2);
+    EXPECT_EQ(calls.loadFile, 2);
+}
+
+TEST_F(FontLoaderTest, reloadedFaceGetsNewId)
+{
+    auto face1 = loader.loadFont(Font{.family = "Regular"});
+    auto alias = loader.loadFont(Font{.family = "Alias"});
+    loader.clearCache();
+    auto face2 = loader.loadFont(Font{.family = "Regular"});
+
+    EXPECT_EQ(face1->id(), alias->id());
+    EXPECT_NE(face1->id(), face2->id());
+}
+
+TEST_F(FontLoaderTest, fallbackIsFirstCoveringFont)
+{
+    auto latin = loader.loadFallbackFont(Font{.family = "Regular"}, U'A');
+    auto cjk = loader.loadFallbackFont(Font{.family = "Regular"}, U'\u3042');
+    auto latinAgain = loader.loadFallbackFont(Font{.family = "Regular"}, U'B');
+
+    ASSERT_NE(latin, nullptr);
+    ASSERT_NE(cjk, nullptr);
+    EXPECT_NE(latin, cjk);
+    EXPECT_EQ(latin, latinAgain);
+    EXPECT_EQ(loader.loadFallbackFont(Font{.family = "Regular"}, U'\u3043'), nullptr);
+    // the fallback list is queried once per font, and each fallback is opened once
+    EXPECT_EQ(calls.fallback, 1);
+    EXPECT_EQ(calls.loadFile, 2);
+}
@@ -0,0 +1,109 @@
+#include <text/freetype/glyph_outline.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace karin;
+
+namespace
+{
+// area covered by the triangles that are fully inside the fill
+float fillArea(const GlyphOutline::Mesh& mesh)
+{
+    float area = 0.0f;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        const auto& a = mesh.vertices[mesh.indices[i]];
+        const auto& b = mesh.vertices[mesh.indices[i + 1]];
+        const auto& c = mesh.vertices[mesh.indices[i + 2]];
+        if (a.coverage < 1.0f || b.coverage < 1.0f || c.coverage < 1.0f)
+        {
+            continue;
+        }
+        Point ab = b.position - a.position;
+        Point ac = c.position - a.position;
+        area += std::abs(ab.x * ac.y - ab.y * ac.x) / 2.0f;
+    }
+    return area;
+}
+
+float contourArea(const std::vector<Point>& contour)
+{
+    float area = 0.0f;
+    for (size_t i = 0; i < contour.size(); ++i)
+    {
+        Point from = contour[i];
+        Point to = contour[(i + 1) % contour.size()];
+        area += from.x * to.y - to.x * from.y;
+    }
+    return area / 2.0f;
+}
+}
+
+class GlyphOutlineTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(FT_Init_FreeType(&library), 0);
+        ASSERT_EQ(FT_New_Face(library, TEST_FONT_PATH, 0, &face), 0);
+    }
+
+    void TearDown() override
+    {
+        FT_Done_Face(face);
+        FT_Done_FreeType(library);
+    }
+
+    static constexpr const char* TEST_FONT_PATH = "fixtures/font/NotoSans-Regular.ttf";
+
+    FT_Library library = nullptr;
+    FT_Face face = nullptr;
+};
+
+TEST_F(GlyphOutlineTest, holeIsNotFilled)
+{
+    auto outline = GlyphOutline::load(face, FT_Get_Char_Index(face, 'O'));
+
+    ASSERT_TRUE(outline);
+    ASSERT_EQ(outline->contours().size(), 2);
+
+    // the outer contour minus the counter
+    float outer = std::abs(contourArea(outline->contours()[0]));
+    float inner = std::abs(contourArea(outline->contours()[1]));
+    float expected = std::abs(outer - inner);
+    EXPECT_NEAR(fillArea(outline->tessellate()), expected, expected * 1e-3f);
+}
+
+TEST_F(GlyphOutlineTest, inEmUnitsYDown)
+{
+    auto outline = GlyphOutline::load(face, FT_Get_Char_Index(face, 'H'));
+
+    ASSERT_TRUE(outline);
+    float top = 0.0f;
+    float left = 1.0f;
+    for (const auto& contour : outline->contours())
+    {
+        for (Point point : contour)
+        {
+            top = std::min(top, point.y);
+            left = std::min(left, point.x);
+            EXPECT_LE(point.y, 0.01f);
+        }
+    }
+    // cap height of Noto Sans: 714 / 1000 em
+    EXPECT_NEAR(top, -0.714f, 0.01f);
+    // x is from the pen position. the left bearing is where the outline starts
+    EXPECT_GT(outline->bearingX(), 0.05f);
+    EXPECT_FLOAT_EQ(outline->bearingX(), left);
+}
+
+TEST_F(GlyphOutlineTest, spaceHasEmptyOutline)
+{
+    auto outline = GlyphOutline::load(face, FT_Get_Char_Index(face, ' '));
+
+    ASSERT_TRUE(outline);
+    EXPECT_TRUE(outline->contours().empty());
+    EXPECT_TRUE(outline->tessellate().indices.empty());
+}
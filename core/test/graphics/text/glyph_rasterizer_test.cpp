@@ -0,0 +1,116 @@
+#include <text/freetype/glyph_rasterizer.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+using namespace karin;
+
+class GlyphRasterizerTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(FT_Init_FreeType(&library), 0);
+        ASSERT_EQ(FT_New_Face(library, TEST_FONT_PATH, 0, &face), 0);
+        owner = std::make_shared<int>(0);
+    }
+
+    void TearDown() override
+    {
+        FT_Done_Face(face);
+        FT_Done_FreeType(library);
+    }
+
+    std::vector<GlyphRasterizer::Request> requests(uint32_t glyphCount, float size) const
+    {
+        std::vector<GlyphRasterizer::Request> result;
+        for (uint32_t i = 0; i < glyphCount; ++i)
+        {
+            result.push_back({.face = face, .owner = owner, .glyphIndex = i, .size = size});
+        }
+        return result;
+    }
+
+    static constexpr const char* TEST_FONT_PATH = "fixtures/font/NotoSans-Regular.ttf";
+
+    FT_Library library = nullptr;
+    FT_Face face = nullptr;
+    std::shared_ptr<int> owner;
+};
+
+TEST_F(GlyphRasterizerTest, parallelMatchesSingleThread)
+{
+    auto batch = requests(200, 24.0f);
+
+    GlyphRasterizer single(1);
+    GlyphRasterizer parallel(4);
+    auto expected = single.rasterize(batch);
+    auto actual = parallel.rasterize(batch);
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i)
+    {
+        EXPECT_EQ(actual[i].error, 0);
+        EXPECT_EQ(actual[i].width, expected[i].width);
+        EXPECT_EQ(actual[i].height, expected[i].height);
+        EXPECT_EQ(actual[i].left, expected[i].left);
+        EXPECT_EQ(actual[i].top, expected[i].top);
+        EXPECT_EQ(actual[i].bitmap, expected[i].bitmap);
+    }
+}
+
+TEST_F(GlyphRasterizerTest, matchesSourceFace)
+{
+    uint32_t glyphIndex = FT_Get_Char_Index(face, 'A');
+    GlyphRasterizer rasterizer(2);
+    auto glyphs = rasterizer.rasterize(std::vector{
+        GlyphRasterizer::Request{.face = face, .owner = owner, .glyphIndex = glyphIndex, .size = 32.0f},
+    });
+
+    FT_Set_Char_Size(face, 0, 32 * 64, 72, 72);
+    FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT);
+    FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+
+    ASSERT_EQ(glyphs.size(), 1);
+    EXPECT_EQ(glyphs[0].width, static_cast<int>(face->glyph->bitmap.width));
+    EXPECT_EQ(glyphs[0].height, static_cast<int>(face->glyph->bitmap.rows));
+    EXPECT_EQ(glyphs[0].top, face->glyph->bitmap_top);
+    EXPECT_GT(glyphs[0].width, 0);
+}
+
+TEST_F(GlyphRasterizerTest, consecutiveBatches)
+{
+    GlyphRasterizer rasterizer(3);
+    for (int i = 0; i < 20; ++i)
+    {
+        auto glyphs = rasterizer.rasterize(requests(10, 12.0f + i));
+        ASSERT_EQ(glyphs.size(), 10);
+    }
+    EXPECT_TRUE(rasterizer.rasterize({}).empty());
+}
+
+TEST_F(GlyphRasterizerTest, distanceFieldHasSpread)
+{
+    if (!GlyphRasterizer::supportsDistanceField())
+    {
+        GTEST_SKIP() << "FreeType without SDF rendering";
+    }
+
+    uint32_t glyphIndex = FT_Get_Char_Index(face, 'A');
+    GlyphRasterizer rasterizer(1);
+    auto glyphs = rasterizer.rasterize(std::vector{
+        GlyphRasterizer::Request{.face = face, .owner = owner, .glyphIndex = glyphIndex, .size = 32.0f},
+        GlyphRasterizer::Request{
+            .face = face, .owner = owner, .glyphIndex = glyphIndex, .size = 32.0f,
+            .format = GlyphRasterizer::Format::DistanceField, .spread = 4
+        },
+    });
+
+    ASSERT_EQ(glyphs.size(), 2);
+    EXPECT_EQ(glyphs[1].error, 0);
+    // the field extends past the outline by the spread on each side
+    EXPECT_GE(glyphs[1].width, glyphs[0].width + 2 * 4 - 2);
+    EXPECT_GE(glyphs[1].height, glyphs[0].height + 2 * 4 - 2);
+}
@@ -0,0 +1,42 @@
+#include <text/layout_worker_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace karin;
+
+TEST(LayoutWorkerPoolTest, returnsResultsThroughFutures)
+{
+    LayoutWorkerPool pool(3);
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 100; ++i)
+    {
+        futures.push_back(pool.submit([i] { return i * i; }));
+    }
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(futures[i].get(), i * i);
+    }
+}
+
+TEST(LayoutWorkerPoolTest, forwardsExceptions)
+{
+    LayoutWorkerPool pool(1);
+    auto future = pool.submit([]() -> std::string { throw std::runtime_error("layout failed"); });
+
+    EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST(LayoutWorkerPoolTest, runsTasksOffTheCallingThread)
+{
+    LayoutWorkerPool pool(2);
+    auto future = pool.submit([] { return std::this_thread::get_id(); });
+
+    EXPECT_NE(future.get(), std::this_thread::get_id());
+}
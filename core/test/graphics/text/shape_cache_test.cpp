@@ -0,0 +1,94 @@
+#include <text/shape_cache.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+using namespace karin;
+
+namespace
+{
+std::shared_ptr<const ShapedRun> makeRun(size_t glyphCount)
+{
+    auto run = std::make_shared<ShapedRun>();
+    for (size_t i = 0; i < glyphCount; ++i)
+    {
+        run->glyphs.push_back(ShapedGlyph{
+            .glyphIndex = static_cast<uint32_t>(i),
+            .cluster = static_cast<uint32_t>(i),
+            .advanceX = 100,
+        });
+    }
+    return run;
+}
+}
+
+class ShapeCacheTest : public testing::Test
+{
+protected:
+    int font1 = 0;
+    int font2 = 0;
+
+    ShapeCache::Key key(std::string_view text, const void* font, std::string_view language = "en-US")
+    {
+        return ShapeCache::Key{
+            .text = text,
+            .font = font,
+            .direction = 0,
+            .language = language,
+        };
+    }
+};
+
+TEST_F(ShapeCacheTest, findInsertedRun)
+{
+    ShapeCache cache;
+    auto run = makeRun(5);
+    cache.insert(key("hello", &font1), nullptr, run);
+
+    EXPECT_EQ(cache.find(key("hello", &font1)), run);
+    EXPECT_EQ(cache.find(key("hello", &font2)), nullptr);
+    EXPECT_EQ(cache.find(key("hello", &font1, "ja-JP")), nullptr);
+    EXPECT_EQ(cache.find(key("hell", &font1)), nullptr);
+}
+
+TEST_F(ShapeCacheTest, evictsLeastRecentlyUsed)
+{
+    ShapeCache cache;
+    cache.insert(key("a", &font1), nullptr, makeRun(1));
+    size_t entrySize = cache.byteSize();
+    cache.setByteBudget(entrySize * 2);
+
+    cache.insert(key("b", &font1), nullptr, makeRun(1));
+    cache.find(key("a", &font1));
+    cache.insert(key("c", &font1), nullptr, makeRun(1));
+
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_NE(cache.find(key("a", &font1)), nullptr);
+    EXPECT_EQ(cache.find(key("b", &font1)), nullptr);
+    EXPECT_NE(cache.find(key("c", &font1)), nullptr);
+    EXPECT_LE(cache.byteSize(), cache.byteBudget());
+}
+
+TEST_F(ShapeCacheTest, runLargerThanBudgetIsNotCached)
+{
+    ShapeCache cache(64);
+    cache.insert(key("long text", &font1), nullptr, makeRun(100));
+
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.byteSize(), 0);
+}
+
+TEST_F(ShapeCacheTest, entryKeepsFontAlive)
+{
+    ShapeCache cache;
+    auto owner = std::make_shared<int>(0);
+    std::weak_ptr<int> weak = owner;
+    cache.insert(key("a", owner.get()), owner, makeRun(1));
+    owner.reset();
+
+    EXPECT_FALSE(weak.expired());
+    cache.clear();
+    EXPECT_TRUE(weak.expired());
+}
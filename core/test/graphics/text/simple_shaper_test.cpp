@@ -0,0 +1,126 @@
+#include <text/simple_shaper.h>
+
+#include <gtest/gtest.h>
+
+#include <string_view>
+#include <vector>
+
+using namespace karin;
+
+namespace
+{
+// the same shaping as TextLayouter::shapeLine
+std::vector<ShapedGlyph> hbShape(hb_font_t* font, std::string_view text, const char* locale)
+{
+    hb_buffer_t* buffer = hb_buffer_create();
+    hb_buffer_add_utf8(buffer, text.data(), static_cast<int>(text.size()), 0, static_cast<int>(text.size()));
+    hb_buffer_set_direction(buffer, HB_DIRECTION_LTR);
+    hb_buffer_set_language(buffer, hb_language_from_string(locale, -1));
+    hb_buffer_guess_segment_properties(buffer);
+    hb_shape(font, buffer, nullptr, 0);
+
+    unsigned int count = 0;
+    hb_glyph_info_t* infos = hb_buffer_get_glyph_infos(buffer, &count);
+    hb_glyph_position_t* positions = hb_buffer_get_glyph_positions(buffer, &count);
+    std::vector<ShapedGlyph> glyphs;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        glyphs.push_back(ShapedGlyph{
+            .glyphIndex = infos[i].codepoint,
+            .cluster = infos[i].cluster,
+            .advanceX = positions[i].x_advance,
+        });
+    }
+    hb_buffer_destroy(buffer);
+    return glyphs;
+}
+}
+
+class SimpleShaperTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        hb_blob_t* blob = hb_blob_create_from_file(TEST_FONT_PATH);
+        hb_face_t* face = hb_face_create(blob, 0);
+        hb_blob_destroy(blob);
+        ASSERT_GT(hb_face_get_glyph_count(face), 0);
+
+        // scaled to units per em, like the fonts TextLayouter shapes with
+        font = hb_font_create(face);
+        int upem = static_cast<int>(hb_face_get_upem(face));
+        hb_font_set_scale(font, upem, upem);
+        hb_face_destroy(face);
+    }
+
+    void TearDown() override
+    {
+        hb_font_destroy(font);
+    }
+
+    void expectSameAsHarfBuzz(const SimpleShaper& shaper, std::string_view text)
+    {
+        std::vector<ShapedGlyph> glyphs;
+        ASSERT_TRUE(shaper.shape(text, glyphs)) << text;
+
+        std::vector<ShapedGlyph> expected = hbShape(font, text, "en-US");
+        ASSERT_EQ(glyphs.size(), expected.size()) << text;
+        for (size_t i = 0; i < glyphs.size(); ++i)
+        {
+            EXPECT_EQ(glyphs[i].glyphIndex, expected[i].glyphIndex) << text << " glyph " << i;
+            EXPECT_EQ(glyphs[i].cluster, expected[i].cluster) << text << " glyph " << i;
+            EXPECT_EQ(glyphs[i].advanceX, expected[i].advanceX) << text << " glyph " << i;
+        }
+    }
+
+    static constexpr const char* TEST_FONT_PATH = "fixtures/font/NotoSans-Regular.ttf";
+
+    hb_font_t* font = nullptr;
+};
+
+TEST_F(SimpleShaperTest, fastPathWithKerning)
+{
+    // the font has GSUB and GPOS lookups for latn, and kerns Latin letters
+    const SimpleShaper* shaper = SimpleShaper::forFont(font, "en-US");
+    ASSERT_NE(shaper, nullptr);
+
+    expectSameAsHarfBuzz(*shaper, "AVATAR");
+    expectSameAsHarfBuzz(*shaper, "Total: 1,234.56 (+7%)");
+    expectSameAsHarfBuzz(*shaper, "Tower \"Wave\" Yard");
+    expectSameAsHarfBuzz(*shaper, "Ça va, Ýves? À bientôt");
+    expectSameAsHarfBuzz(*shaper, "0123456789");
+
+    std::vector<ShapedGlyph> glyphs;
+    ASSERT_TRUE(shaper->shape("AV", glyphs));
+    EXPECT_LT(glyphs[0].advanceX, hb_font_get_glyph_h_advance(font, glyphs[0].glyphIndex));
+}
+
+TEST_F(SimpleShaperTest, ligatureFallsBack)
+{
+    const SimpleShaper* shaper = SimpleShaper::forFont(font, "en-US");
+    ASSERT_NE(shaper, nullptr);
+
+    // fi and ffi are ligatures in the font
+    ASSERT_LT(hbShape(font, "office", "en-US").size(), std::string_view("office").size());
+    std::vector<ShapedGlyph> glyphs;
+    EXPECT_FALSE(shaper->shape("office", glyphs));
+    EXPECT_FALSE(shaper->shape("fi", glyphs));
+    expectSameAsHarfBuzz(*shaper, "fo if");
+}
+
+TEST_F(SimpleShaperTest, outsideLatin1FallsBack)
+{
+    const SimpleShaper* shaper = SimpleShaper::forFont(font, "en-US");
+    ASSERT_NE(shaper, nullptr);
+
+    std::vector<ShapedGlyph> glyphs;
+    EXPECT_FALSE(shaper->shape("Ωmega", glyphs));
+    EXPECT_FALSE(shaper->shape("tab\there", glyphs));
+}
+
+TEST_F(SimpleShaperTest, languageSystemFallsBack)
+{
+    // the font has a Catalan language system for latn
+    EXPECT_EQ(SimpleShaper::forFont(font, "ca"), nullptr);
+    EXPECT_NE(SimpleShaper::forFont(font, "de"), nullptr);
+}
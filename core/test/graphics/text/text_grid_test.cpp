@@ -0,0 +1,85 @@
+#include <karin/graphics/text_grid.h>
+
+#include <gtest/gtest.h>
+
+using namespace karin;
+
+namespace
+{
+TextGrid makeGrid(uint32_t columns, uint32_t rows)
+{
+    return TextGrid(columns, rows, nullptr, Font(), 16.0f, TextGridMetrics{.cellSize = {8.0f, 16.0f}});
+}
+}
+
+TEST(TextGridTest, setTextDecodesUtf8)
+{
+    TextGrid grid = makeGrid(4, 2);
+    TextGridCell style;
+    style.underline = true;
+
+    EXPECT_EQ(grid.setText(1, 0, "a\xC3\xA9\xE3\x81\x82\xF0\x9F\x98\x80", style), 3);
+    EXPECT_EQ(grid.cell(0, 0).codepoint, U' ');
+    EXPECT_EQ(grid.cell(1, 0).codepoint, U'a');
+    EXPECT_EQ(grid.cell(2, 0).codepoint, U'é');
+    EXPECT_EQ(grid.cell(3, 0).codepoint, U'あ');
+    EXPECT_TRUE(grid.cell(3, 0).underline);
+
+    EXPECT_EQ(grid.setText(0, 1, "\xC3x", style), 2);
+    EXPECT_EQ(grid.cell(0, 1).codepoint, U'�');
+    EXPECT_EQ(grid.cell(1, 1).codepoint, U'x');
+}
+
+TEST(TextGridTest, versionChangesOnlyWithContent)
+{
+    TextGrid grid = makeGrid(3, 2);
+    uint64_t version0 = grid.slotVersion(grid.rowSlot(0));
+    uint64_t version1 = grid.slotVersion(grid.rowSlot(1));
+
+    grid.setText(0, 0, "abc", {});
+    EXPECT_NE(grid.slotVersion(grid.rowSlot(0)), version0);
+    EXPECT_EQ(grid.slotVersion(grid.rowSlot(1)), version1);
+
+    version0 = grid.slotVersion(grid.rowSlot(0));
+    grid.setText(0, 0, "abc", {});
+    EXPECT_EQ(grid.slotVersion(grid.rowSlot(0)), version0);
+}
+
+TEST(TextGridTest, scrollKeepsSlotsOfMovedRows)
+{
+    TextGrid grid = makeGrid(2, 3);
+    grid.setText(0, 0, "aa", {});
+    grid.setText(0, 1, "bb", {});
+    grid.setText(0, 2, "cc", {});
+    uint32_t slot1 = grid.rowSlot(1);
+    uint64_t version1 = grid.slotVersion(slot1);
+
+    grid.scroll(1);
+    EXPECT_EQ(grid.cell(0, 0).codepoint, U'b');
+    EXPECT_EQ(grid.cell(0, 1).codepoint, U'c');
+    EXPECT_EQ(grid.cell(0, 2).codepoint, U' ');
+    EXPECT_EQ(grid.rowSlot(0), slot1);
+    EXPECT_EQ(grid.slotVersion(slot1), version1);
+
+    grid.scroll(-2);
+    EXPECT_EQ(grid.cell(0, 0).codepoint, U' ');
+    EXPECT_EQ(grid.cell(0, 1).codepoint, U' ');
+    EXPECT_EQ(grid.cell(0, 2).codepoint, U'b');
+}
+
+TEST(TextGridTest, resizeKeepsTopLeft)
+{
+    TextGrid grid = makeGrid(3, 2);
+    grid.setText(0, 0, "abc", {});
+    grid.setText(0, 1, "def", {});
+    grid.scroll(1);
+
+    grid.resize(2, 3);
+    EXPECT_EQ(grid.columns(), 2);
+    EXPECT_EQ(grid.rows(), 3);
+    EXPECT_EQ(grid.cell(0, 0).codepoint, U'd');
+    EXPECT_EQ(grid.cell(1, 0).codepoint, U'e');
+    EXPECT_EQ(grid.cell(0, 2).codepoint, U' ');
+    EXPECT_EQ(grid.size(), Size(16.0f, 48.0f));
+    EXPECT_THROW(grid.cell(2, 0), std::out_of_range);
+}
@@ -0,0 +1,183 @@
+#include <text/text_layouter.h>
+#include <text/harfbuzz_provider.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace karin;
+
+namespace
+{
+constexpr const char* TEST_FONT_PATH = "fixtures/font/NotoSans-Regular.ttf";
+
+// HarfBuzz's own font functions, scaled to units per em like the platform faces. a missing file is an empty face
+class HbFontFace : public IFontFace, public IHarfBuzzProvider
+{
+public:
+    explicit HbFontFace(const std::string& filePath)
+    {
+        hb_blob_t* blob = hb_blob_create_from_file(filePath.c_str());
+        hb_face_t* face = hb_face_create(blob, 0);
+        hb_blob_destroy(blob);
+
+        m_unitsPerEm = static_cast<uint16_t>(hb_face_get_upem(face));
+        m_font = hb_font_create(face);
+        hb_font_set_scale(m_font, m_unitsPerEm, m_unitsPerEm);
+        hb_face_destroy(face);
+    }
+
+    ~HbFontFace() override
+    {
+        hb_font_destroy(m_font);
+    }
+
+    hb_font_t* getHbFont() const override
+    {
+        return m_font;
+    }
+
+    FontMetrics getFontMetrics() const override
+    {
+        return {.unitsPerEm = m_unitsPerEm, .capHeight = m_unitsPerEm};
+    }
+
+    GlyphMetrics getGlyphMetrics(uint32_t glyphIndex) const override
+    {
+        return {.glyphIndex = glyphIndex};
+    }
+
+private:
+    hb_font_t* m_font;
+    uint16_t m_unitsPerEm;
+};
+
+// the fallback of every font is the test font, said to cover A-Z, a-z, space and U+3042
+class FakePlatformFontLoader : public IPlatformFontLoader
+{
+public:
+    std::unique_ptr<IFontFace> loadFont(const Font& /*font*/) override
+    {
+        return {};
+    }
+
+    std::unique_ptr<IFontFace> loadFontFromFile(const std::string& filePath, uint32_t /*faceIndex*/) override
+    {
+        return std::make_unique<HbFontFace>(filePath);
+    }
+
+    std::vector<Font> getFontLists() override
+    {
+        return {};
+    }
+
+    std::vector<FallbackFont> findFallbackFonts(const Font& /*font*/) override
+    {
+        auto coverage = std::make_shared<FontCoverage>();
+        for (char32_t c = U'A'; c <= U'Z'; ++c)
+        {
+            coverage->add(c);
+            coverage->add(c - U'A' + U'a');
+        }
+        coverage->add(U' ');
+        coverage->add(U'あ');
+        return {{.location = {.filePath = TEST_FONT_PATH}, .coverage = coverage}};
+    }
+};
+}
+
+class TextLayouterTest : public testing::Test
+{
+protected:
+    std::vector<GlyphPosition> layout(
+        TextLayouter& layouter,
+        const IFontFace& face,
+        std::string_view text,
+        std::vector<std::shared_ptr<IFontFace>>& outFallbackFaces
+    )
+    {
+        std::vector<GlyphPosition> glyphs;
+        Size contentSize{};
+        layouter.layout(&face, text, textStyle, paragraphStyle, Size{}, glyphs, outFallbackFaces, contentSize);
+        return glyphs;
+    }
+
+    HbFontFace face{TEST_FONT_PATH};
+    TextStyle textStyle{16.0f, "Test"};
+    ParagraphStyle paragraphStyle;
+    FontLoader fallbackLoader{std::make_unique<FakePlatformFontLoader>()};
+};
+
+TEST_F(TextLayouterTest, shapedLinesAreCached)
+{
+    TextLayouter layouter;
+    std::vector<std::shared_ptr<IFontFace>> fallbackFaces;
+
+    // ffi is a ligature, so the line is shaped by HarfBuzz and cached
+    std::vector<GlyphPosition> first = layout(layouter, face, "office", fallbackFaces);
+    EXPECT_LT(first.size(), std::string_view("office").size());
+    EXPECT_EQ(layouter.shapeCache().size(), 1u);
+
+    std::vector<GlyphPosition> second = layout(layouter, face, "office", fallbackFaces);
+    ASSERT_EQ(second.size(), first.size());
+    for (size_t i = 0; i < first.size(); ++i)
+    {
+        EXPECT_EQ(second[i].glyphIndex, first[i].glyphIndex);
+        EXPECT_EQ(second[i].position.x, first[i].position.x);
+    }
+    EXPECT_EQ(layouter.shapeCache().size(), 1u);
+
+    // kerned Latin text takes the simple shaper and is not cached
+    EXPECT_EQ(layout(layouter, face, "AVATAR", fallbackFaces).size(), 6u);
+    EXPECT_EQ(layouter.shapeCache().size(), 1u);
+
+    // without the simple shaper the same text is shaped by HarfBuzz
+    textStyle.locale = "ca";
+    EXPECT_EQ(layout(layouter, face, "AVATAR", fallbackFaces).size(), 6u);
+    EXPECT_EQ(layouter.shapeCache().size(), 2u);
+}
+
+TEST_F(TextLayouterTest, uncoveredTextIsShapedWithFallback)
+{
+    HbFontFace empty{"fixtures/font/missing.ttf"};
+    TextLayouter layouter(ShapeCache::DEFAULT_BYTE_BUDGET, &fallbackLoader);
+    TextLayouter plainLayouter;
+    std::vector<std::shared_ptr<IFontFace>> fallbackFaces;
+    std::vector<std::shared_ptr<IFontFace>> noFallbackFaces;
+
+    std::vector<GlyphPosition> glyphs = layout(layouter, empty, "AVATAR office", fallbackFaces);
+    std::vector<GlyphPosition> expected = layout(plainLayouter, face, "AVATAR office", noFallbackFaces);
+
+    ASSERT_EQ(fallbackFaces.size(), 1u);
+    EXPECT_TRUE(noFallbackFaces.empty());
+    ASSERT_EQ(glyphs.size(), expected.size());
+    for (size_t i = 0; i < glyphs.size(); ++i)
+    {
+        EXPECT_EQ(glyphs[i].face, 1u);
+        EXPECT_EQ(glyphs[i].glyphIndex, expected[i].glyphIndex);
+        EXPECT_FLOAT_EQ(glyphs[i].position.x, expected[i].position.x);
+    }
+}
+
+TEST_F(TextLayouterTest, lineIsSplitIntoRunsByFace)
+{
+    TextLayouter layouter(ShapeCache::DEFAULT_BYTE_BUDGET, &fallbackLoader);
+    std::vector<std::shared_ptr<IFontFace>> fallbackFaces;
+
+    // the test font has no U+3042, so it comes from the fallback, between two runs of the requested face
+    std::vector<GlyphPosition> glyphs = layout(layouter, face, "AVあok", fallbackFaces);
+
+    ASSERT_EQ(fallbackFaces.size(), 1u);
+    ASSERT_EQ(glyphs.size(), 5u);
+    std::vector<uint32_t> faces;
+    for (const GlyphPosition& glyph : glyphs)
+    {
+        faces.push_back(glyph.face);
+    }
+    EXPECT_EQ(faces, (std::vector<uint32_t>{0, 0, 1, 0, 0}));
+    EXPECT_LT(glyphs[1].position.x, glyphs[2].position.x);
+    EXPECT_LT(glyphs[2].position.x, glyphs[3].position.x);
+}
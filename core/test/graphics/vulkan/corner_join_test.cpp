@@ -0,0 +1,29 @@
+#include <vulkan/corner_join.h>
+
+#include <gtest/gtest.h>
+
+using namespace karin;
+
+TEST(CornerJoinTest, miterWithinLimitStaysSquare)
+{
+    StrokeStyle strokeStyle{.width = 4.0f};
+    EXPECT_EQ(rightAngleJoinStyle(strokeStyle), StrokeStyle::JoinStyle::Miter);
+
+    strokeStyle.miter_limit = 1.5f;
+    EXPECT_EQ(rightAngleJoinStyle(strokeStyle), StrokeStyle::JoinStyle::Miter);
+}
+
+TEST(CornerJoinTest, miterOverLimitIsBeveled)
+{
+    StrokeStyle strokeStyle{.width = 4.0f, .join_style = StrokeStyle::JoinStyle::Miter, .miter_limit = 1.0f};
+    EXPECT_EQ(rightAngleJoinStyle(strokeStyle), StrokeStyle::JoinStyle::Bevel);
+}
+
+TEST(CornerJoinTest, roundAndBevelAreKept)
+{
+    StrokeStyle strokeStyle{.width = 4.0f, .join_style = StrokeStyle::JoinStyle::Round, .miter_limit = 1.0f};
+    EXPECT_EQ(rightAngleJoinStyle(strokeStyle), StrokeStyle::JoinStyle::Round);
+
+    strokeStyle.join_style = StrokeStyle::JoinStyle::Bevel;
+    EXPECT_EQ(rightAngleJoinStyle(strokeStyle), StrokeStyle::JoinStyle::Bevel);
+}
@@ -0,0 +1,43 @@
+#include <vulkan/glyph_quad.h>
+#include <text/freetype/glyph_rasterizer.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+using namespace karin;
+
+TEST(GlyphQuadTest, bearingIsAppliedOnce)
+{
+    FT_Library library = nullptr;
+    FT_Face face = nullptr;
+    ASSERT_EQ(FT_Init_FreeType(&library), 0);
+    ASSERT_EQ(FT_New_Face(library, "fixtures/font/NotoSans-Regular.ttf", 0, &face), 0);
+
+    constexpr float size = 48.0f;
+    uint32_t glyphIndex = FT_Get_Char_Index(face, 'H');
+    ASSERT_EQ(FT_Load_Glyph(face, glyphIndex, FT_LOAD_NO_SCALE), 0);
+    float bearingX = static_cast<float>(face->glyph->metrics.horiBearingX) * size / face->units_per_EM;
+
+    GlyphRasterizer rasterizer(1);
+    auto glyphs = rasterizer.rasterize(std::vector{
+        GlyphRasterizer::Request{.face = face, .owner = std::make_shared<int>(0), .glyphIndex = glyphIndex, .size = size},
+    });
+    ASSERT_EQ(glyphs.size(), 1);
+    const GlyphRasterizer::Glyph& glyph = glyphs[0];
+
+    // TextLayouter puts the glyph at the pen position plus its left bearing
+    constexpr float penX = 100.0f;
+    Point quadOrigin = glyphQuadOrigin(
+        {penX + bearingX, 50.0f}, static_cast<float>(glyph.left), static_cast<float>(glyph.top), glyph.bearingX, 1.0f
+    );
+
+    ASSERT_GT(bearingX, 2.0f);
+    // the bitmap sits where FreeType places it from the pen. hinting moves it by less than a pixel
+    EXPECT_NEAR(quadOrigin.x, penX + static_cast<float>(glyph.left), 1.0f);
+    EXPECT_FLOAT_EQ(quadOrigin.y, 50.0f - static_cast<float>(glyph.top));
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+}
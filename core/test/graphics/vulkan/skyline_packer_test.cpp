@@ -0,0 +1,96 @@
+#include <vulkan/skyline_packer.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace karin;
+
+namespace
+{
+struct PackedRect
+{
+    int x;
+    int y;
+    int width;
+    int height;
+
+    bool overlaps(const PackedRect& other) const
+    {
+        return x < other.x + other.width && other.x < x + width
+            && y < other.y + other.height && other.y < y + height;
+    }
+};
+}
+
+TEST(SkylinePackerTest, packsLeftToRightThenUp)
+{
+    SkylinePacker packer(100, 100);
+
+    auto first = packer.pack(60, 10);
+    auto second = packer.pack(40, 20);
+    auto third = packer.pack(50, 10);
+
+    ASSERT_TRUE(first && second && third);
+    EXPECT_EQ(first->x, 0);
+    EXPECT_EQ(first->y, 0);
+    EXPECT_EQ(second->x, 60);
+    EXPECT_EQ(second->y, 0);
+    // lands on the lower skyline segment
+    EXPECT_EQ(third->x, 0);
+    EXPECT_EQ(third->y, 10);
+}
+
+TEST(SkylinePackerTest, rejectsRectanglesThatDoNotFit)
+{
+    SkylinePacker packer(64, 64);
+
+    EXPECT_FALSE(packer.pack(65, 1));
+    EXPECT_FALSE(packer.pack(1, 65));
+    EXPECT_FALSE(packer.pack(0, 10));
+
+    ASSERT_TRUE(packer.pack(64, 60));
+    EXPECT_FALSE(packer.pack(10, 10));
+    EXPECT_TRUE(packer.pack(10, 4));
+}
+
+TEST(SkylinePackerTest, packedRectanglesDoNotOverlap)
+{
+    SkylinePacker packer(256, 256);
+    std::vector<PackedRect> packed;
+
+    for (int i = 0; i < 400; ++i)
+    {
+        int width = 3 + (i * 7) % 17;
+        int height = 4 + (i * 5) % 13;
+        auto position = packer.pack(width, height);
+        if (!position)
+        {
+            continue;
+        }
+
+        PackedRect rect{position->x, position->y, width, height};
+        EXPECT_LE(rect.x + rect.width, 256);
+        EXPECT_LE(rect.y + rect.height, 256);
+        for (const auto& other : packed)
+        {
+            ASSERT_FALSE(rect.overlaps(other));
+        }
+        packed.push_back(rect);
+    }
+
+    EXPECT_GT(packed.size(), 300);
+}
+
+TEST(SkylinePackerTest, resetFreesEverything)
+{
+    SkylinePacker packer(32, 32);
+    ASSERT_TRUE(packer.pack(32, 32));
+    EXPECT_FALSE(packer.pack(1, 1));
+
+    packer.reset();
+    auto position = packer.pack(32, 32);
+    ASSERT_TRUE(position);
+    EXPECT_EQ(position->x, 0);
+    EXPECT_EQ(position->y, 0);
+}